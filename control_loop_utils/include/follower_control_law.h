@@ -0,0 +1,67 @@
+#ifndef FOLLOWER_CONTROL_LAW_H
+#define FOLLOWER_CONTROL_LAW_H
+
+#include <vector>
+#include <Eigen/Eigen>
+#include <geometry_msgs/PoseStamped.h>
+
+/** Control law of the trajectory follower: look-ahead point on the path plus the velocity module of the nearest point.
+ *  It does not depend on ROS communication, so the closed-loop simulator calls it directly.
+ */
+namespace FollowerControl{
+
+const float velocity_error = 0.1; /**< velocity added to the velocity module of the path */
+
+/** \brief Utility function to calculate the nearest pose on the path
+ *  \param positions a path to follow
+ *  \param current_pose pose of the drone
+ *  \param previous_pose_on_path the search starts from this index
+ *  \return index of the nearest pose on the path
+ */
+inline int cal_pose_on_path(const std::vector<geometry_msgs::PoseStamped> &positions, const Eigen::Vector3f &current_pose, int previous_pose_on_path){
+    double min_distance = 10000000;
+    int pose_on_path_id = 0;
+    for(int i=previous_pose_on_path; i<positions.size();i++){
+        Eigen::Vector3f pose_on_path = Eigen::Vector3f(positions[i].pose.position.x, positions[i].pose.position.y, positions[i].pose.position.z);
+        if((current_pose - pose_on_path).norm()<min_distance){
+            min_distance = (current_pose - pose_on_path).norm();
+            pose_on_path_id = i;
+        }
+    }
+    return pose_on_path_id;
+}
+
+/** \brief Utility function to calculate the look ahead position
+ *  \param positions a path to follow
+ *  \param look_ahead
+ *  \pose_on_path pose from which we apply look ahead
+ *  \return look ahead position index
+ */
+inline int cal_pose_look_ahead(const std::vector<geometry_msgs::PoseStamped> &positions, const double look_ahead, int pose_on_path){
+    for(int i = pose_on_path; i<positions.size();i++){
+        Eigen::Vector3f aux = Eigen::Vector3f(positions[i].pose.position.x-positions[pose_on_path].pose.position.x, positions[i].pose.position.y-positions[pose_on_path].pose.position.y, positions[i].pose.position.z-positions[pose_on_path].pose.position.z);
+        double distance = aux.norm();
+        if(distance>look_ahead) return i;
+    }
+    return positions.size();
+}
+
+/** \brief utility function to calculate velocity commands. This function apply the direction to the next point of the trajectory and the velocity of the nearest point of the trajectory.
+ *  \param pose desired position of the path
+ *  \param vel desired velocity of the nearest pose on the path
+ *  \param current_pose pose of the drone
+ *  \return 3d vector velocity to command
+ */
+inline Eigen::Vector3f calculate_vel(Eigen::Vector3f pose, Eigen::Vector3f vel, const Eigen::Vector3f &current_pose){
+   Eigen::Vector3f vel_to_command = (pose - current_pose).normalized();
+   double vel_module = vel.norm()+velocity_error;
+   /**if(vel_module<0.15){
+       vel_module = 0.15;
+   }
+    std::cout<<vel_module<<std::endl;*/
+   return vel_to_command*vel_module;
+}
+
+}
+
+#endif
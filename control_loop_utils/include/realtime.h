@@ -0,0 +1,134 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <vector>
+
+/**
+*  \brief Real-time profile of the control loops. A thread can be moved to SCHED_FIFO and pinned to some cpus, so the planning and the
+*         following keep their cadence when the companion computer is loaded by the simulator, the autopilot interface or the vision.
+*         The period of the loops is measured by CycleStatistics, to check the cadence that is actually kept.
+*         SCHED_FIFO needs CAP_SYS_NICE or an rtprio limit (/etc/security/limits.conf). Without them the thread keeps the default scheduler.
+*/
+namespace Realtime{
+
+/** Scheduling of a thread
+ */
+struct Profile{
+    int priority = 0;        /**< SCHED_FIFO priority (1-99). 0: default scheduler */
+    std::vector<int> cpus;   /**< cpus the thread can run on. Empty: all of them */
+};
+
+/** \brief apply a profile to the calling thread. The threads it creates afterwards inherit it
+ *  \param error why the profile can't be applied
+ *  \return false if the priority or the cpus can't be set. The part that could be set is kept
+ */
+inline bool apply(const Profile &profile, std::string &error){
+    error.clear();
+    if(!profile.cpus.empty()){
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for(const int cpu : profile.cpus){
+            if(cpu >= 0 && cpu < CPU_SETSIZE){
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        const int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if(result != 0){
+            error = std::string("affinity: ") + strerror(result);
+        }
+    }
+    if(profile.priority > 0){
+        sched_param parameters;
+        parameters.sched_priority = std::min(profile.priority, sched_get_priority_max(SCHED_FIFO));
+        const int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+        if(result != 0){
+            error += (error.empty() ? "" : ", ") + std::string("SCHED_FIFO: ") + strerror(result);
+        }
+    }
+    return error.empty();
+}
+
+/** \brief cpus of a profile as text, for the logs */
+inline std::string cpusText(const Profile &profile){
+    if(profile.cpus.empty()){
+        return "all";
+    }
+    std::string text;
+    for(const int cpu : profile.cpus){
+        text += (text.empty() ? "" : ",") + std::to_string(cpu);
+    }
+    return text;
+}
+
+/** Period of a periodic loop: extremes, mean, jitter (standard deviation) and histogram. tick() is called at the start of every cycle.
+ *  The histogram has BINS bins up to twice the nominal period, the last one has the longer cycles. It does not allocate
+ */
+class CycleStatistics{
+
+public:
+    static const int BINS = 20;
+    static constexpr double OVERRUN_TOLERANCE = 0.1;  /**< a cycle longer than the nominal period by this fraction is an overrun */
+
+    /** \param nominal_period period the loop is run at (s) */
+    explicit CycleStatistics(const double nominal_period) : nominal_period_(nominal_period), bin_width_(2.0*nominal_period/BINS){
+        histogram_.fill(0);
+    }
+
+    /** \brief start of a cycle. The period is measured from the previous start, unless restart() was called after it */
+    void tick(const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()){
+        if(running_){
+            const double period = std::chrono::duration<double>(now-last_tick_).count();
+            cycles_++;
+            last_ = period;
+            min_ = cycles_ == 1 ? period : std::min(min_, period);
+            max_ = cycles_ == 1 ? period : std::max(max_, period);
+            // Welford
+            const double delta = period-mean_;
+            mean_ += delta/cycles_;
+            squares_ += delta*(period-mean_);
+            histogram_[std::min<int>(period/bin_width_, BINS-1)]++;
+            if(period > (1.0+OVERRUN_TOLERANCE)*nominal_period_){
+                overruns_++;
+            }
+        }
+        last_tick_ = now;
+        running_ = true;
+    }
+    /** \brief the loop stopped (e.g. idle), the next tick does not close a period */
+    void restart(){ running_ = false; }
+
+    double nominalPeriod() const { return nominal_period_; }
+    double binWidth() const { return bin_width_; }
+    uint64_t cycles() const { return cycles_; }
+    uint64_t overruns() const { return overruns_; }
+    double last() const { return last_; }
+    double min() const { return min_; }
+    double max() const { return max_; }
+    double mean() const { return mean_; }
+    double jitter() const { return cycles_ > 1 ? std::sqrt(squares_/(cycles_-1)) : 0.0; }
+    const std::array<uint32_t, BINS> &histogram() const { return histogram_; }
+
+private:
+    const double nominal_period_;
+    const double bin_width_;
+    std::chrono::steady_clock::time_point last_tick_;
+    bool running_ = false;
+    uint64_t cycles_ = 0;    /**< periods measured */
+    uint64_t overruns_ = 0;
+    double last_ = 0.0, min_ = 0.0, max_ = 0.0, mean_ = 0.0;
+    double squares_ = 0.0;   /**< sum of the squared deviations from the mean */
+    std::array<uint32_t, BINS> histogram_;
+};
+
+}
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+/**
+*  \brief Structured trace for the control loops. A trace call saves its level, time, format and up to MAX_VALUES numbers in a ring
+*         buffer, without formatting them: the text is only made when the buffer is dumped. The formats can only have floating point
+*         conversions (%f, %.2f, %g...), integers are saved as doubles and printed with %.0f. The dump formats them itself, so it
+*         can run in the signal handlers: flags and widths are ignored, and %e and %g are written in fixed point.
+*         - Levels below TRACE_MIN_LEVEL are removed at compile time (default: INFO, so TRACE_DEBUG costs nothing).
+*         - Every call site has a minimum period between records. The calls in between are only counted.
+*         - The buffer is dumped to a file on SIGUSR1 (kill -USR1 <pid>) or on a crash, once install() has been called.
+*         The buffer is shared by all threads. It is lock free, so a record being written while the buffer wraps can be mixed up.
+*/
+#define TRACE_LEVEL_DEBUG 0
+#define TRACE_LEVEL_INFO  1
+#define TRACE_LEVEL_WARN  2
+#define TRACE_LEVEL_ERROR 3
+
+#ifndef TRACE_MIN_LEVEL
+#define TRACE_MIN_LEVEL TRACE_LEVEL_INFO
+#endif
+
+#define TRACE_RECORD(level, period, ...)                              \
+    do {                                                              \
+        static Trace::Site trace_site_(period);                       \
+        Trace::record(trace_site_, level, __VA_ARGS__);               \
+    } while (0)
+
+#if TRACE_MIN_LEVEL <= TRACE_LEVEL_DEBUG
+#define TRACE_DEBUG(period, ...) TRACE_RECORD(TRACE_LEVEL_DEBUG, period, __VA_ARGS__)
+#else
+#define TRACE_DEBUG(period, ...) do {} while (0)
+#endif
+#if TRACE_MIN_LEVEL <= TRACE_LEVEL_INFO
+#define TRACE_INFO(period, ...) TRACE_RECORD(TRACE_LEVEL_INFO, period, __VA_ARGS__)
+#else
+#define TRACE_INFO(period, ...) do {} while (0)
+#endif
+#if TRACE_MIN_LEVEL <= TRACE_LEVEL_WARN
+#define TRACE_WARN(period, ...) TRACE_RECORD(TRACE_LEVEL_WARN, period, __VA_ARGS__)
+#else
+#define TRACE_WARN(period, ...) do {} while (0)
+#endif
+#define TRACE_ERROR(period, ...) TRACE_RECORD(TRACE_LEVEL_ERROR, period, __VA_ARGS__)
+
+namespace Trace{
+
+const int MAX_VALUES = 7;
+const size_t CAPACITY = 4096;  /**< records in the ring buffer */
+
+/** State of a call site, for the rate limiting
+ */
+struct Site{
+    explicit Site(const double min_period) : min_period_ns(min_period * 1e9) {}
+    const int64_t min_period_ns;
+    std::atomic<int64_t> last_ns{INT64_MIN / 2};
+    std::atomic<uint32_t> suppressed{0};  /**< calls since the last record */
+};
+
+struct Record{
+    int64_t time_ns = 0;       /**< steady clock */
+    const char *format = nullptr;
+    uint8_t level = 0;
+    uint8_t n_values = 0;
+    uint32_t suppressed = 0;   /**< calls of the site that were not recorded before this one */
+    double values[MAX_VALUES] = {};
+};
+
+struct Buffer{
+    Record records[CAPACITY];
+    std::atomic<uint64_t> next{0};
+    char dump_path[256] = "";
+};
+
+inline Buffer &buffer(){
+    static Buffer buffer;
+    return buffer;
+}
+
+inline int64_t now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void setValues(Record &, const int){}
+
+template<typename Value, typename... Values>
+inline void setValues(Record &entry, const int index, const Value &value, const Values &... values){
+    if(index < MAX_VALUES){
+        entry.values[index] = static_cast<double>(value);
+        entry.n_values = index + 1;
+        setValues(entry, index + 1, values...);
+    }
+}
+
+/** \brief save a record if the period of the site has passed. Called by the TRACE macros
+ */
+template<typename... Values>
+inline void record(Site &site, const uint8_t level, const char *format, const Values &... values){
+    const int64_t time = now();
+    int64_t last = site.last_ns.load(std::memory_order_relaxed);
+    if(time - last < site.min_period_ns || !site.last_ns.compare_exchange_strong(last, time, std::memory_order_relaxed)){
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Buffer &ring = buffer();
+    Record &entry = ring.records[ring.next.fetch_add(1, std::memory_order_relaxed) % CAPACITY];
+    entry.time_ns = time;
+    entry.format = format;
+    entry.level = level;
+    entry.suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    entry.n_values = 0;
+    setValues(entry, 0, values...);
+}
+
+/** Line of the dump. It is formatted without the C library (snprintf is not async-signal-safe), the text that does not fit is cut
+ */
+struct Line{
+    char text[512];
+    int size = 0;
+
+    void append(const char c){
+        if(size < (int)sizeof(text) - 1){  // room for the end of line
+            text[size++] = c;
+        }
+    }
+    void append(const char *characters){
+        while(*characters){
+            append(*characters++);
+        }
+    }
+    /** \param digits minimum number of digits, with leading zeros */
+    void appendUnsigned(uint64_t value, const int digits = 1){
+        char reversed[20];
+        int n = 0;
+        do{
+            reversed[n++] = '0' + value % 10;
+            value /= 10;
+        }while(value > 0 || n < std::min(digits, 20));
+        while(n > 0){
+            append(reversed[--n]);
+        }
+    }
+    /** \param precision decimals, at most 9 */
+    void appendFixed(double value, int precision){
+        if(value != value){
+            append("nan");
+            return;
+        }
+        if(value < 0){
+            append('-');
+            value = -value;
+        }
+        if(value >= 1e18){
+            append(value > 1e308 ? "inf" : ">1e18");
+            return;
+        }
+        precision = std::min(std::max(precision, 0), 9);
+        uint64_t scale = 1;
+        for(int i = 0; i < precision; i++){
+            scale *= 10;
+        }
+        uint64_t integer = static_cast<uint64_t>(value);
+        uint64_t fraction = static_cast<uint64_t>((value - integer) * scale + 0.5);
+        if(fraction >= scale){
+            integer++;
+            fraction -= scale;
+        }
+        appendUnsigned(integer);
+        if(precision > 0){
+            append('.');
+            appendUnsigned(fraction, precision);
+        }
+    }
+    /** \brief format of a record: every conversion takes the next value */
+    void appendFormat(const char *format, const double values[], const int n_values){
+        int value = 0;
+        for(const char *c = format; *c; c++){
+            if(*c != '%'){
+                append(*c);
+                continue;
+            }
+            c++;
+            if(*c == '%'){
+                append('%');
+                continue;
+            }
+            while(*c == '-' || *c == '+' || *c == ' ' || *c == '#' || (*c >= '0' && *c <= '9')){
+                c++;
+            }
+            int precision = 6;
+            if(*c == '.'){
+                precision = 0;
+                for(c++; *c >= '0' && *c <= '9'; c++){
+                    precision = std::min(10 * precision + (*c - '0'), 9);
+                }
+            }
+            while(*c == 'l' || *c == 'L'){
+                c++;
+            }
+            if(!*c){
+                return;
+            }
+            const int start = size;
+            appendFixed(value < n_values ? values[value] : 0.0, precision);
+            value++;
+            // %g without the trailing zeros
+            if((*c == 'g' || *c == 'G') && precision > 0 && size < (int)sizeof(text) - 1){
+                while(size > start && text[size - 1] == '0'){
+                    size--;
+                }
+                if(size > start && text[size - 1] == '.'){
+                    size--;
+                }
+            }
+        }
+    }
+};
+
+/** \brief write the buffer as text, oldest record first. It only formats with Line and calls write, so it can be called from the
+ *         signal handlers
+ *  \param fd file descriptor
+ */
+inline void dump(const int fd){
+    static const char *LEVELS[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+    Buffer &ring = buffer();
+    const uint64_t next = ring.next.load();
+    const int64_t time = now();
+    for(uint64_t i = next > CAPACITY ? next - CAPACITY : 0; i < next; i++){
+        const Record &entry = ring.records[i % CAPACITY];
+        if(!entry.format){
+            continue;
+        }
+        Line line;
+        line.append('[');
+        line.appendFixed((time - entry.time_ns) * 1e-9, 3);
+        line.append(" s ago] ");
+        line.append(LEVELS[entry.level & 3]);
+        line.append(' ');
+        line.appendFormat(entry.format, entry.values, std::min<int>(entry.n_values, MAX_VALUES));
+        if(entry.suppressed > 0){
+            line.append(" (");
+            line.appendUnsigned(entry.suppressed);
+            line.append(" calls not recorded)");
+        }
+        line.text[line.size++] = '\n';
+        if(write(fd, line.text, line.size) < 0){
+            return;
+        }
+    }
+}
+
+/** \brief write the buffer in a file
+ *  \return false if the file can't be created
+ */
+inline bool dump(const char *path){
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0){
+        return false;
+    }
+    dump(fd);
+    close(fd);
+    return true;
+}
+
+inline void signalHandler(const int signal){
+    dump(buffer().dump_path);
+    if(signal != SIGUSR1){
+        // crash: default action after the dump
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+}
+
+/** \brief dump the buffer on SIGUSR1 and on crashes (SIGSEGV, SIGABRT, SIGFPE, SIGBUS)
+ *  \param name name of the node. The buffer is dumped to /tmp/<name>.trace, with the slashes of the name changed to underscores
+ *  \return path of the dump file
+ */
+inline std::string install(const std::string &name){
+    std::string path = name;
+    for(char &c : path){
+        c = (c == '/') ? '_' : c;
+    }
+    path = "/tmp/" + path + ".trace";
+    strncpy(buffer().dump_path, path.c_str(), sizeof(buffer().dump_path) - 1);
+    for(const int signal : {SIGUSR1, SIGSEGV, SIGABRT, SIGFPE, SIGBUS}){
+        std::signal(signal, signalHandler);
+    }
+    return path;
+}
+
+}
+
+#endif
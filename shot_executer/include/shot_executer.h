@@ -6,6 +6,9 @@
 #include <nav_msgs/Odometry.h>
 #include <nav_msgs/Path.h>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include <geometry_msgs/TwistStamped.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <shot_executer/ShootingAction.h>
@@ -38,6 +41,56 @@ class ShotExecuter
          *  \param _nh public nodehandle
          */
         ShotExecuter(ros::NodeHandle &_nh, ros::NodeHandle &_pnh, std::string frame);
+        /** \brief The scheduler thread must have been stopped (stop()) by the derived class or the owner: it calls the virtual functions
+         *         and the publishers of the derived class, which are already destroyed here
+         */
+        virtual ~ShotExecuter();
+        /** \brief Start the scheduler thread. It must be called once the derived class is fully constructed
+         */
+        void start();
+        /** \brief Stop the scheduler thread and wait for it to finish. It must be called before the derived class is destroyed
+         */
+        void stop();
+
+        /* Struct to define the shooting action
+        */
+        struct shooting_action{
+            std::string start_event = "";
+            int shooting_action_type = 0;
+            double duration = 0.0;
+            double length = 0.0;
+            int target_type;
+            geometry_msgs::Vector3 rt_parameters; 
+        };
+        /* Struct with a consistent copy of the target and drone state. It is taken once per tick so that the desired pose
+         * and the gimbal command are calculated from the same data
+        */
+        struct target_snapshot{
+            nav_msgs::Odometry target_pose;
+            nav_msgs::Odometry drone_pose;
+            double target_yaw = 0.0;
+        };
+
+        /** \brief Velocity constant model for the target trajectory prediction
+         *  \param target_pose last target odometry
+         *  \param time_horizon number of steps
+         *  \param step_size step size (seconds)
+         *  \return The predicted target trajectory
+         */
+        static std::vector<nav_msgs::Odometry> velocityConstantPrediction(const nav_msgs::Odometry &target_pose, const int time_horizon, const float step_size);
+        /** \brief Calculate desired pose. If type flyby, calculate wrt last mission pose . If lateral, calculate wrt time horizon pose
+         *         For the shots relative to the target, the desired pose is also evaluated at every predicted target point (reference_trajectory)
+         *         and desired_odometry is the last point of it.
+         *         It only depends on its arguments, so it can be used without a running node (e.g. by the closed-loop simulator)
+         *  \TODO   z position and velocity, angle relative to target
+         *  \TODO   calculate orientation by velocity and apply it to desired pose
+         */
+        static shot_executer::DesiredShot calculateDesiredPoint(const struct shooting_action &_shooting_action, const std::vector<nav_msgs::Odometry> &target_trajectory, const target_snapshot &snapshot);
+        /** \brief This function calculates the camera angles needed to point to the target.
+         *  \param snapshot target and drone state
+         *  \return camera angles [roll yaw pitch]
+         */
+        static Eigen::Vector3f calculateGimbalAngles(const target_snapshot &snapshot);
     protected:
 
         //ROS (publishers, subscribers)
@@ -52,22 +105,12 @@ class ShotExecuter
         nav_msgs::Odometry target_pose_;            /*< target pose */
         nav_msgs::Odometry drone_pose_;             /*< drone pose*/
 
-        /* Struct to define the shooting action
-        */
-        struct shooting_action{
-            std::string start_event = "";
-            int shooting_action_type = 0;
-            double duration = 0.0;
-            double length = 0.0;
-            int target_type;
-            geometry_msgs::Vector3 rt_parameters; 
-        };
         Eigen::Vector3f camera_angles_; /**< member to save the angles of the camera to point the target. It is calculate by calculateGimbalAngles*/
-        const int ROLL = 0;
-        const int YAW = 1;
-        const int PITCH = 2;
+        static const int ROLL = 0;
+        static const int YAW = 1;
+        static const int PITCH = 2;
         const float MIN_XY_VEL = 0.4;
-        double target_orientation_[3];
+        double target_orientation_[3] = {0.0, 0.0, 0.0};
         int prediction_mode_ = 0; /**< to predict the direction of the target using target velocity (velocity mode = 0) or target orientation (orientation mode = 1)*/
         const int VELOCITY_MODE = 0;    /**< trajectory predicted using the target velocity */
         const int ORIENTATION_MODE = 1; /**< trajectory predicted using the target orientation */
@@ -78,43 +121,46 @@ class ShotExecuter
         const float step_size_ = 0.2;    /**< step size (seconds) */
         const int time_horizon_= 40; /*< Number of steps */ 
         float rate_pose_publisher_ = 5; /**< Rate to publish the desired pose (Hz) */
-        float rate_camera_publisher_ = 10; /**< Rate to publish the camera pose (Hz) */
-        std::thread action_thread_;  /*< thread that publish the desired pose */
-        std::thread camera_thread_;  /*< thread that publish the pith and yaw needed for the camera pointing to the target */
-        
-        bool new_shooting_action_received_ = false;
-        bool shooting_action_running_ = false;
+        float rate_camera_publisher_ = 10; /**< Rate to publish the camera pose (Hz). It is the tick rate of the scheduler */
+        std::thread scheduler_thread_;  /*< thread that publishes the desired pose and the camera command */
+        std::atomic<bool> running_{false}; /*< the scheduler thread keeps running while true */
+        std::shared_ptr<shooting_action> pending_action_; /*< command slot for new shooting actions. Only accessed through std::atomic_* */
+        std::mutex state_mutex_; /*< protects target_pose_, drone_pose_ and target_orientation_ */
+
+        /** \brief Copy the target and drone state under the state mutex
+         *  \return snapshot used in the whole tick
+         */
+        target_snapshot takeSnapshot();
         /** \brief This predicts the target trajectory over time_horizon_. We use a velocity cte model.
          *          Besides, publish the predicted trajectory for visualization
+         *  \param snapshot target state of this tick
          *  \return The predicted target trajectory 
          */
-        std::vector<nav_msgs::Odometry> targetTrajectoryPrediction();
-
-        /** \brief Calculate desired pose. If type flyby, calculate wrt last mission pose . If lateral, calculate wrt time horizon pose
-         *  \TODO   z position and velocity, angle relative to target
-         *  \TODO   calculate orientation by velocity and apply it to desired pose
+        std::vector<nav_msgs::Odometry> targetTrajectoryPrediction(const target_snapshot &snapshot);
+        /** \brief Evaluate a shot over the predicted target trajectory in one vectorized pass:
+         *         position_i = position_mask * target_position_i + offset, velocity_i = velocity_mask * target_velocity_i
+         *  \param target_trajectory predicted target trajectory
+         *  \param position_mask 1 for the axes relative to the target, 0 for the absolute ones
+         *  \param offset relative distance (or absolute position for the axes with mask 0)
+         *  \param velocity_mask 1 for the axes that follow the target velocity
+         *  \param orientation desired orientation for every step
+         *  \return desired odometry at each step of the horizon
          */
-        shot_executer::DesiredShot calculateDesiredPoint(const struct shooting_action _shooting_action, const std::vector<nav_msgs::Odometry> &target_trajectory);
-        /** \brief Callback for action service. Receive the request and start a thread with this request actionThread()
-         *         If there are any shooting action active, it command it to finish and wait it to finish
+        static std::vector<nav_msgs::Odometry> shotReferenceTrajectory(const std::vector<nav_msgs::Odometry> &target_trajectory, const Eigen::Vector3d &position_mask,
+                                                                       const Eigen::Vector3d &offset, const Eigen::Vector3d &velocity_mask, const geometry_msgs::Quaternion &orientation);
+        /** \brief Callback for action service. Receive the request and leave it in the command slot.
+         *         The scheduler thread picks it up in its next tick, so this callback never blocks
          */
         bool actionCallback(shot_executer::ShootingAction::Request  &req, shot_executer::ShootingAction::Response &res);
-        /** \brief This function predicts the target trajectory and calculates the desired pose while the shooting action lasts or while a new one is received.
-         *  \param _shooting_action shooting action to execute 
+        /** \brief Single event loop of the node. Each tick it takes the pending shooting action (if any), takes a snapshot of the state,
+         *         publishes the camera command and, at rate_pose_publisher_, predicts the target trajectory and publishes the desired pose.
          *  \TODO implement time_reached
          *  \TODO implement distance_reached
          */
-        void actionThread(struct shooting_action _shooting_action);
+        void schedulerThread();
         /** \brief Callback for the target pose
          */
         void targetPoseCallback(const nav_msgs::Odometry::ConstPtr& _msg);
-        /** \brief This function calculates the camera angles needed to point to the target.
-         *         It is saved in camera_angles_ member
-         */
-        void calculateGimbalAngles();
-        /** This thread is publishing camera_angles_ every time.
-         */
-        void cameraThread();
         /** \brief prototype function to call the camera topic
          */
         virtual void publishCameraCommand();
@@ -8,6 +8,7 @@
 class ShotExecuterMRS : public ShotExecuter{
     public:
         ShotExecuterMRS(ros::NodeHandle &_nh, ros::NodeHandle &_pnh);
+        ~ShotExecuterMRS();
     private:
         ros::ServiceClient motors_client_;
         ros::ServiceClient arming_client_;
@@ -7,6 +7,7 @@
 class ShotExecuterUAL : public ShotExecuter{
     public:
         ShotExecuterUAL(ros::NodeHandle &_nh, ros::NodeHandle &_pnh);
+        ~ShotExecuterUAL();
     private:
         const std::string frame_ = "map";
         ros::Subscriber ual_pose_subscriber_;
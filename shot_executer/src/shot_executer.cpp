@@ -1,4 +1,5 @@
 #include <shot_executer.h>
+#include <trace.h>
 #ifdef MULTIDRONE
     #include <multidrone_msgs/ExecuteAction.h>
     #include <multidrone_msgs/DroneAction.h>
@@ -19,6 +20,28 @@ ShotExecuter::ShotExecuter(ros::NodeHandle &_nh,ros::NodeHandle &_pnh, std::stri
     shooting_action_srv_ = _nh.advertiseService("action",&ShotExecuter::actionCallback,this);
 }
 
+ShotExecuter::~ShotExecuter(){
+    if(scheduler_thread_.joinable()){
+        ROS_ERROR("Shot executer destroyed with the scheduler running, stop() must be called by the derived class");
+        stop();
+    }
+}
+
+void ShotExecuter::stop(){
+    running_ = false;
+    if(scheduler_thread_.joinable()){
+        scheduler_thread_.join();
+    }
+}
+
+void ShotExecuter::start(){
+    if(running_.exchange(true)){
+        ROS_WARN("Shot executer already started");
+        return;
+    }
+    scheduler_thread_ = std::thread(&ShotExecuter::schedulerThread,this);
+}
+
 
 /** \brief this function publish the desired pose in a ros point type
  *  \param x,y,z        Desired pose
@@ -37,12 +60,13 @@ void ShotExecuter::publishDesiredPoint(nav_msgs::Odometry desired_odometry) {
 /** \brief 
  */
 void ShotExecuter::publishCameraCommand(){
-    ROS_WARN("Publish camera command of the base class");
+    ROS_WARN_ONCE("Publish camera command of the base class");
 }
 /** \brief target array for real experiment
  */
 void ShotExecuter::targetPoseCallback(const nav_msgs::Odometry::ConstPtr& _msg) // real target callback
 {
+    std::lock_guard<std::mutex> lock(state_mutex_);
     target_pose_ = *_msg;
     // that is valid if the velocity is not equal to zero or threshold
 
@@ -57,27 +81,43 @@ void ShotExecuter::targetPoseCallback(const nav_msgs::Odometry::ConstPtr& _msg)
         m.getRPY(target_orientation_[ROLL], target_orientation_[PITCH], target_orientation_[YAW]);
     }
     bool xy_small = (xy_module<MIN_XY_VEL);
-    std::cout<<"target pose received and xy small: "<<xy_small<<std::endl;
+    TRACE_DEBUG(1.0, "target pose received and xy small: %.0f", xy_small);
+}
+
+ShotExecuter::target_snapshot ShotExecuter::takeSnapshot(){
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    target_snapshot snapshot;
+    snapshot.target_pose = target_pose_;
+    snapshot.drone_pose = drone_pose_;
+    snapshot.target_yaw = target_orientation_[YAW];
+    return snapshot;
 }
 
-std::vector<nav_msgs::Odometry> ShotExecuter::targetTrajectoryPrediction(){
+std::vector<nav_msgs::Odometry> ShotExecuter::velocityConstantPrediction(const nav_msgs::Odometry &target_pose, const int time_horizon, const float step_size){
     std::vector<nav_msgs::Odometry> target_trajectory;
     nav_msgs::Odometry aux;
-    nav_msgs::Path path_to_publish;  //rviz
-    geometry_msgs::PoseStamped aux_path;
 
     // velocity constant model for target trajectory prediction
-    for(int i=0; i<time_horizon_;i++){
-        aux.pose.pose.position.x = target_pose_.pose.pose.position.x+step_size_*i*target_pose_.twist.twist.linear.x;
-        aux.pose.pose.position.y = target_pose_.pose.pose.position.y+step_size_*i*target_pose_.twist.twist.linear.y;
-        aux.pose.pose.position.z = target_pose_.pose.pose.position.z+step_size_*i*target_pose_.twist.twist.linear.z;
-        aux.twist.twist = target_pose_.twist.twist;
-        // to visualize
-        aux_path.pose.position.x = aux.pose.pose.position.x;
-        aux_path.pose.position.y = aux.pose.pose.position.y;
-        aux_path.pose.position.z = aux.pose.pose.position.z;
-
+    for(int i=0; i<time_horizon;i++){
+        aux.pose.pose.position.x = target_pose.pose.pose.position.x+step_size*i*target_pose.twist.twist.linear.x;
+        aux.pose.pose.position.y = target_pose.pose.pose.position.y+step_size*i*target_pose.twist.twist.linear.y;
+        aux.pose.pose.position.z = target_pose.pose.pose.position.z+step_size*i*target_pose.twist.twist.linear.z;
+        aux.twist.twist = target_pose.twist.twist;
         target_trajectory.push_back(aux);
+    }
+    return target_trajectory;
+}
+
+std::vector<nav_msgs::Odometry> ShotExecuter::targetTrajectoryPrediction(const target_snapshot &snapshot){
+    std::vector<nav_msgs::Odometry> target_trajectory = velocityConstantPrediction(snapshot.target_pose, time_horizon_, step_size_);
+    nav_msgs::Path path_to_publish;  //rviz
+    geometry_msgs::PoseStamped aux_path;
+
+    // to visualize
+    for(size_t i=0; i<target_trajectory.size();i++){
+        aux_path.pose.position.x = target_trajectory[i].pose.pose.position.x;
+        aux_path.pose.position.y = target_trajectory[i].pose.pose.position.y;
+        aux_path.pose.position.z = target_trajectory[i].pose.pose.position.z;
         path_to_publish.poses.push_back(aux_path);
     }
 
@@ -88,12 +128,14 @@ std::vector<nav_msgs::Odometry> ShotExecuter::targetTrajectoryPrediction(){
 
 
 
-shot_executer::DesiredShot ShotExecuter::calculateDesiredPoint(const struct shooting_action _shooting_action, const std::vector<nav_msgs::Odometry> &target_trajectory){
-
+shot_executer::DesiredShot ShotExecuter::calculateDesiredPoint(const struct shooting_action &_shooting_action, const std::vector<nav_msgs::Odometry> &target_trajectory, const target_snapshot &snapshot){
 
+    const nav_msgs::Odometry &drone_pose = snapshot.drone_pose;
+    const double target_yaw = snapshot.target_yaw;
+    const Eigen::Vector3f camera_angles = calculateGimbalAngles(snapshot);
     // publish the orientation of the desired point as the orientation of the camera
     tf2::Quaternion myQuaternion;
-    myQuaternion.setRPY( 0, camera_angles_[PITCH], camera_angles_[YAW]);  // Create this quaternion from roll/pitch/YAW (in radian
+    myQuaternion.setRPY( 0, camera_angles[PITCH], camera_angles[YAW]);  // Create this quaternion from roll/pitch/YAW (in radian
     //int dur = (int)(shooting_duration*10);
     nav_msgs::Odometry desired_point;
     shot_executer::DesiredShot desired_shot;
@@ -121,40 +163,37 @@ shot_executer::DesiredShot ShotExecuter::calculateDesiredPoint(const struct shoo
         return desired_shot;
     
     case shot_executer::ShootingAction::Request::ELEVATOR:
-        desired_point.pose.pose.position.x  = drone_pose_.pose.pose.position.x;//target_trajectory.back().pose.pose.position.x+_shooting_action.rt_parameters.x; //-10 //+(cos(-0.9)*_shooting_action.rt_parameters.x-sin(-0.9)*_shooting_action.rt_parameters.y);
-        desired_point.pose.pose.position.y = drone_pose_.pose.pose.position.y;
-        desired_point.pose.pose.position.z = target_trajectory[time_horizon_-1].pose.pose.position.z+_shooting_action.rt_parameters.z;
-        // desired vel
-        desired_point.twist.twist.linear.x =0;
-        desired_point.twist.twist.linear.y =0;
-        desired_point.twist.twist.linear.z =target_trajectory.back().twist.twist.linear.z;
-        desired_shot.desired_odometry = desired_point;
+        // x, y fixed at the drone pose. z relative to the target
+        desired_shot.reference_trajectory = shotReferenceTrajectory(target_trajectory,
+                        Eigen::Vector3d(0.0, 0.0, 1.0),
+                        Eigen::Vector3d(drone_pose.pose.pose.position.x, drone_pose.pose.pose.position.y, _shooting_action.rt_parameters.z),
+                        Eigen::Vector3d(0.0, 0.0, 1.0), desired_point.pose.pose.orientation);
+        desired_shot.desired_odometry = desired_shot.reference_trajectory.back();
         desired_shot.type = shot_executer::DesiredShot::SHOT;
         return desired_shot;
 
 
     case shot_executer::ShootingAction::Request::FOLLOW:
-        desired_point.pose.pose.position.x  = target_trajectory[time_horizon_-1].pose.pose.position.x+(cos(target_orientation_[YAW])*_shooting_action.rt_parameters.x-sin(target_orientation_[YAW])*_shooting_action.rt_parameters.y);//target_trajectory.back().pose.pose.position.x+_shooting_action.rt_parameters.x; //-10 //+(cos(-0.9)*_shooting_action.rt_parameters.x-sin(-0.9)*_shooting_action.rt_parameters.y);
-        desired_point.pose.pose.position.y = target_trajectory[time_horizon_-1].pose.pose.position.y+(sin(target_orientation_[YAW])*_shooting_action.rt_parameters.x+cos(target_orientation_[YAW])*_shooting_action.rt_parameters.y);
-        desired_point.pose.pose.position.z = target_trajectory[time_horizon_-1].pose.pose.position.z+_shooting_action.rt_parameters.z;
-        // desired vel
-        desired_point.twist.twist.linear.x =target_trajectory.back().twist.twist.linear.x;
-        desired_point.twist.twist.linear.y =target_trajectory.back().twist.twist.linear.y;
-        desired_point.twist.twist.linear.z =0;
-        desired_shot.desired_odometry = desired_point;
+        // relative distance rotated with the target orientation
+        desired_shot.reference_trajectory = shotReferenceTrajectory(target_trajectory,
+                        Eigen::Vector3d(1.0, 1.0, 1.0),
+                        Eigen::Vector3d(cos(target_yaw)*_shooting_action.rt_parameters.x-sin(target_yaw)*_shooting_action.rt_parameters.y,
+                                        sin(target_yaw)*_shooting_action.rt_parameters.x+cos(target_yaw)*_shooting_action.rt_parameters.y,
+                                        _shooting_action.rt_parameters.z),
+                        Eigen::Vector3d(1.0, 1.0, 0.0), desired_point.pose.pose.orientation);
+        desired_shot.desired_odometry = desired_shot.reference_trajectory.back();
         desired_shot.type = shot_executer::DesiredShot::SHOT;
         return desired_shot;
 
     case shot_executer::ShootingAction::Request::FLYOVER:
-        desired_point.pose.pose.position.x  = target_trajectory[time_horizon_-1].pose.pose.position.x+(cos(target_orientation_[YAW])*_shooting_action.rt_parameters.x-sin(target_orientation_[YAW])*_shooting_action.rt_parameters.y);
-        desired_point.pose.pose.position.y = target_trajectory[time_horizon_-1].pose.pose.position.y+(sin(target_orientation_[YAW])*_shooting_action.rt_parameters.x+cos(target_orientation_[YAW])*_shooting_action.rt_parameters.y);
-        desired_point.pose.pose.position.z  = _shooting_action.rt_parameters.z;
-
-        // desired
-        desired_point.twist.twist.linear.x =target_trajectory[time_horizon_-1].twist.twist.linear.x;
-        desired_point.twist.twist.linear.y =target_trajectory[time_horizon_-1].twist.twist.linear.y;
-        desired_point.twist.twist.linear.z =0;
-        desired_shot.desired_odometry = desired_point;
+        // as follow, but at a fixed height
+        desired_shot.reference_trajectory = shotReferenceTrajectory(target_trajectory,
+                        Eigen::Vector3d(1.0, 1.0, 0.0),
+                        Eigen::Vector3d(cos(target_yaw)*_shooting_action.rt_parameters.x-sin(target_yaw)*_shooting_action.rt_parameters.y,
+                                        sin(target_yaw)*_shooting_action.rt_parameters.x+cos(target_yaw)*_shooting_action.rt_parameters.y,
+                                        _shooting_action.rt_parameters.z),
+                        Eigen::Vector3d(1.0, 1.0, 0.0), desired_point.pose.pose.orientation);
+        desired_shot.desired_odometry = desired_shot.reference_trajectory.back();
         desired_shot.type = shot_executer::DesiredShot::SHOT;
         return desired_shot;
     
@@ -178,66 +217,92 @@ shot_executer::DesiredShot ShotExecuter::calculateDesiredPoint(const struct shoo
     }
 }
 
+std::vector<nav_msgs::Odometry> ShotExecuter::shotReferenceTrajectory(const std::vector<nav_msgs::Odometry> &target_trajectory, const Eigen::Vector3d &position_mask,
+                                                                      const Eigen::Vector3d &offset, const Eigen::Vector3d &velocity_mask, const geometry_msgs::Quaternion &orientation){
+    const int n = target_trajectory.size();
+    Eigen::Matrix3Xd target_positions(3, n);
+    Eigen::Matrix3Xd target_velocities(3, n);
+    for(int i=0; i<n; i++){
+        target_positions.col(i) << target_trajectory[i].pose.pose.position.x, target_trajectory[i].pose.pose.position.y, target_trajectory[i].pose.pose.position.z;
+        target_velocities.col(i) << target_trajectory[i].twist.twist.linear.x, target_trajectory[i].twist.twist.linear.y, target_trajectory[i].twist.twist.linear.z;
+    }
+    // reference_i = mask * target_i + offset, for the whole horizon at once
+    const Eigen::Matrix3Xd positions = (position_mask.asDiagonal()*target_positions).colwise() + offset;
+    const Eigen::Matrix3Xd velocities = velocity_mask.asDiagonal()*target_velocities;
+
+    std::vector<nav_msgs::Odometry> reference(n);
+    for(int i=0; i<n; i++){
+        reference[i].pose.pose.position.x = positions(0,i);
+        reference[i].pose.pose.position.y = positions(1,i);
+        reference[i].pose.pose.position.z = positions(2,i);
+        reference[i].pose.pose.orientation = orientation;
+        reference[i].twist.twist.linear.x = velocities(0,i);
+        reference[i].twist.twist.linear.y = velocities(1,i);
+        reference[i].twist.twist.linear.z = velocities(2,i);
+    }
+    return reference;
+}
+
 bool ShotExecuter::actionCallback(shot_executer::ShootingAction::Request  &req, shot_executer::ShootingAction::Response &res){
     ROS_INFO("action callback");
-    struct shooting_action shooting_action;
-    shooting_action.shooting_action_type = req.shooting_action_type;
-    shooting_action.rt_parameters = req.rt_parameter;
-    shooting_action.duration = req.duration;
-    shooting_action.length = req.length;
-    shooting_action.target_type = req.target_type;
-    if(shooting_action_running_) 
-    {
-        new_shooting_action_received_ = true;
-    } 
-    if(action_thread_.joinable()){
-        action_thread_.join();
-    }
-    action_thread_ = std::thread(&ShotExecuter::actionThread,this,shooting_action);
-    new_shooting_action_received_ = false;
+    std::shared_ptr<shooting_action> action = std::make_shared<shooting_action>();
+    action->shooting_action_type = req.shooting_action_type;
+    action->rt_parameters = req.rt_parameter;
+    action->duration = req.duration;
+    action->length = req.length;
+    action->target_type = req.target_type;
+    // the scheduler takes it in its next tick. If a previous one was not taken yet, it is replaced
+    std::atomic_store(&pending_action_, action);
     res.received = true;
     return true;
 }
 
-void ShotExecuter::cameraThread(){
-    ROS_INFO("camera thread initialized");
+/** \brief Scheduler thread. The camera command is published every tick and the desired pose every pose_ticks ticks
+ */
+void ShotExecuter::schedulerThread(){
+    ROS_INFO("scheduler thread initialized");
     ros::Rate rate(rate_camera_publisher_);
-    while(ros::ok){
+    const int pose_ticks = std::max(1, (int)round(rate_camera_publisher_/rate_pose_publisher_));
+    std::shared_ptr<shooting_action> current_action;
+    int tick = 0;
+    while(running_ && ros::ok()){
+        // take the new shooting action if any. It takes effect in this same tick
+        std::shared_ptr<shooting_action> new_action = std::atomic_exchange(&pending_action_, std::shared_ptr<shooting_action>());
+        if(new_action){
+            current_action = new_action;
+            tick = 0;
+            ROS_INFO("new shooting action: %d", current_action->shooting_action_type);
+        }
+        const target_snapshot snapshot = takeSnapshot();
+        camera_angles_ = calculateGimbalAngles(snapshot);
         publishCameraCommand();
+
+        if(current_action && tick % pose_ticks == 0){
+            std::vector<nav_msgs::Odometry> target_trajectory = targetTrajectoryPrediction(snapshot);
+            shot_executer::DesiredShot desired_shot = calculateDesiredPoint(*current_action,target_trajectory,snapshot);
+            publishDesiredPoint(desired_shot.desired_odometry);
+            // publish desired pose
+            desired_shot.desired_odometry.header.frame_id = "uav"+std::to_string(drone_id_)+"/gps_origin";
+            desired_pose_pub_.publish(desired_shot);
+        }
+        tick++;
         rate.sleep();
     }
 }
-/** \brief Shooting action thread callback
- */
-void ShotExecuter::actionThread(struct shooting_action shooting_action){
-    ROS_INFO("action thread");
-    bool time_reached = false;
-    bool distance_reached = false;
-    ros::Rate rate(rate_pose_publisher_);  
-    shooting_action_running_ = true;    
-    while(!time_reached && !distance_reached && ros::ok() && !new_shooting_action_received_){
-        std::vector<nav_msgs::Odometry> target_trajectory = targetTrajectoryPrediction();
-        shot_executer::DesiredShot desired_shot = calculateDesiredPoint(shooting_action,target_trajectory);
-        publishDesiredPoint(desired_shot.desired_odometry);
-        // publish desired pose
-        desired_shot.desired_odometry.header.frame_id = "uav"+std::to_string(drone_id_)+"/gps_origin";
-        desired_pose_pub_.publish(desired_shot);
-        ROS_INFO("desired_pose published");
-        rate.sleep();
-    }
-    shooting_action_running_ = false;
-}
 
-void ShotExecuter::calculateGimbalAngles(){
-    Eigen::Vector3f target_pose = Eigen::Vector3f(target_pose_.pose.pose.position.x,target_pose_.pose.pose.position.y,target_pose_.pose.pose.position.z);
-    Eigen::Vector3f drone_pose = Eigen::Vector3f(drone_pose_.pose.pose.position.x,drone_pose_.pose.pose.position.y,drone_pose_.pose.pose.position.z);
+Eigen::Vector3f ShotExecuter::calculateGimbalAngles(const target_snapshot &snapshot){
+    const nav_msgs::Odometry &target = snapshot.target_pose;
+    const nav_msgs::Odometry &drone = snapshot.drone_pose;
+    Eigen::Vector3f camera_angles = Eigen::Vector3f::Zero();
+    Eigen::Vector3f target_pose = Eigen::Vector3f(target.pose.pose.position.x,target.pose.pose.position.y,target.pose.pose.position.z);
+    Eigen::Vector3f drone_pose = Eigen::Vector3f(drone.pose.pose.position.x,drone.pose.pose.position.y,drone.pose.pose.position.z);
     Eigen::Vector3f q_camera_target = drone_pose-target_pose;
     float aux_sqrt = sqrt(pow(q_camera_target[0], 2.0)+pow(q_camera_target[1],2.0));
-    camera_angles_[PITCH] =1.57- atan2(aux_sqrt,q_camera_target[2]);  //-
-    camera_angles_[YAW] = atan2(-q_camera_target[1],-q_camera_target[0]);
+    camera_angles[PITCH] =1.57- atan2(aux_sqrt,q_camera_target[2]);  //-
+    camera_angles[YAW] = atan2(-q_camera_target[1],-q_camera_target[0]);
     //std::cout<<"YAW: "<<camera_angles_[YAW]<<std::endl;
     //std::cout<<"pitch: "<<camera_angles_[pitch]<<std::endl;
-
+    return camera_angles;
 }
 
 
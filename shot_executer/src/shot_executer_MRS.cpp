@@ -20,17 +20,21 @@ ShotExecuterMRS::ShotExecuterMRS(ros::NodeHandle &_nh, ros::NodeHandle &_pnh) :
     uav_odometry_sub = _nh.subscribe<nav_msgs::Odometry>("odometry/odom_main",1, &ShotExecuterMRS::uavCallback, this);
 
     //callTakeOff();
-    camera_thread_ = std::thread(&ShotExecuterMRS::cameraThread,this);
+}
+
+ShotExecuterMRS::~ShotExecuterMRS(){
+    // the scheduler publishes the camera command with the members of this class
+    stop();
 }
 
 void ShotExecuterMRS::uavCallback(const nav_msgs::Odometry::ConstPtr &msg)
 {
+    std::lock_guard<std::mutex> lock(state_mutex_);
     drone_pose_ = *msg;
 }
 
 void ShotExecuterMRS::publishCameraCommand(){
     std_msgs::Float32 msg;
-    calculateGimbalAngles();
     msg.data = camera_angles_[PITCH];
     camera_pub_.publish(msg);
 }
@@ -4,7 +4,13 @@ ShotExecuterUAL::ShotExecuterUAL(ros::NodeHandle &_nh, ros::NodeHandle &_pnh) :
 
     ual_pose_subscriber_ = _nh.subscribe("ual/pose",1,&ShotExecuterUAL::ualPoseCallback,this);
 }
+
+ShotExecuterUAL::~ShotExecuterUAL(){
+    // the scheduler uses the members of this class
+    stop();
+}
 void ShotExecuterUAL::ualPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &msg)
 {
+    std::lock_guard<std::mutex> lock(state_mutex_);
     drone_pose_.pose.pose = msg->pose;
 }
@@ -1,11 +1,13 @@
 #include <shot_executer_UAL.h>
 #include <shot_executer_MRS.h>
+#include <trace.h>
 /** \brief main function of the shot executer node
 */
 
 int main(int _argc, char **_argv)
 {
     ros::init(_argc, _argv, "shot_executer");
+    Trace::install(ros::this_node::getName());
     ros::NodeHandle nh;
     ros::NodeHandle pnh("~");
 
@@ -27,6 +29,8 @@ int main(int _argc, char **_argv)
     }else{
         shot_executer_interface = std::make_unique<ShotExecuterUAL>(nh,pnh);
     }
+    shot_executer_interface->start();
     ros::spin();
+    shot_executer_interface->stop();
     return 0;
 }
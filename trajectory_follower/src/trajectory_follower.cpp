@@ -1,5 +1,6 @@
 #include <ros/ros.h>
 #include <optimal_control_interface/Solver.h>
+#include <optimal_control_interface/CycleStatistics.h>
 #include <geometry_msgs/Point.h>
 #include <Eigen/Eigen>
 #include <geometry_msgs/TwistStamped.h>
@@ -11,6 +12,9 @@
 #include <nav_msgs/Path.h>
 #include <fstream>
 #include <iostream>
+#include <follower_control_law.h>
+#include <trace.h>
+#include <realtime.h>
 
 
 std::vector<geometry_msgs::Twist> velocities; //trajectory to follow
@@ -18,13 +22,14 @@ std::vector<geometry_msgs::PoseStamped> positions;  //trajectory to follow
 Eigen::Vector3f current_pose;                 
 Eigen::Vector3f current_vel;                 
 const double look_ahead = 1.0;
+const double control_period = 0.1; // period of the velocity commands (s)
+const double statistics_period = 1.0; // period of the cycle statistics (s), about the planner cycle
 int pose_on_path = 0;
 int target_pose; // look ahead pose
 int drone_id = 1;
 bool start_trajectory = false;  //flag to start the trajectory
 std::string path_csv = "/home/alfonso/traj1";
 ros::Publisher csv_trajectory_pub;
-const float velocity_error = 0.1;
 std::ofstream csv_ual; // logging the pose
 std::ofstream csv_record; // logging the pose
 
@@ -58,54 +63,6 @@ void trajectoryCallback(const optimal_control_interface::Solver::ConstPtr &msg){
     }
 }
 
-/** \brief Utility function to calculate the nearest pose on the path
- *  \param positions a path to follow
- *  \return index of the nearest pose on the path
- */
-int cal_pose_on_path(const std::vector<geometry_msgs::PoseStamped> &positions, int previous_pose_on_path){
-    double min_distance = 10000000;
-    int pose_on_path_id = 0;
-    for(int i=previous_pose_on_path; i<positions.size();i++){
-        Eigen::Vector3f pose_on_path = Eigen::Vector3f(positions[i].pose.position.x, positions[i].pose.position.y, positions[i].pose.position.z);
-        if((current_pose - pose_on_path).norm()<min_distance){
-            min_distance = (current_pose - pose_on_path).norm();
-            pose_on_path_id = i;
-        }
-    }
-    return pose_on_path_id;
-}
-
-/** \brief Utility function to calculate the look ahead position
- *  \param positions a path to follow
- *  \param look_ahead
- *  \pose_on_path pose from which we apply look ahead
- *  \return look ahead position index
- */
-
-int cal_pose_look_ahead(const std::vector<geometry_msgs::PoseStamped> &positions, const double look_ahead, int pose_on_path){
-    for(int i = pose_on_path; i<positions.size();i++){
-        Eigen::Vector3f aux = Eigen::Vector3f(positions[i].pose.position.x-positions[pose_on_path].pose.position.x, positions[i].pose.position.y-positions[pose_on_path].pose.position.y, positions[i].pose.position.z-positions[pose_on_path].pose.position.z);
-        double distance = aux.norm();
-        if(distance>look_ahead) return i;
-    }
-    return positions.size();
-}
-
-/** \brief utility function to calculate velocity commands. This function apply the direction to the next point of the trajectory and the velocity of the nearest point of the trajectory.
- *  \param pose desired position of the path
- *  \param vel desired velocity of the nearest pose on the path
- *  \return 3d vector velocity to command
- */
-Eigen::Vector3f calculate_vel(Eigen::Vector3f pose, Eigen::Vector3f vel){
-   Eigen::Vector3f vel_to_command = (pose - current_pose).normalized();
-   double vel_module = vel.norm()+velocity_error;
-   /**if(vel_module<0.15){
-       vel_module = 0.15;
-   }
-    std::cout<<vel_module<<std::endl;*/
-   return vel_to_command*vel_module;
-}
-
 /**
  */
 
@@ -194,6 +151,7 @@ int main(int _argc, char **_argv)
 {
 
     ros::init(_argc, _argv, "trajectory_follower_node");
+    Trace::install(ros::this_node::getName());
     ros::NodeHandle nh;
     ros::Subscriber trajectory_sub = nh.subscribe<optimal_control_interface::Solver>("solver/trajectory", 1, trajectoryCallback);
     ros::Subscriber ual_pose_sub = nh.subscribe<geometry_msgs::PoseStamped>("ual/pose", 1, ualPoseCallback);
@@ -201,6 +159,7 @@ int main(int _argc, char **_argv)
     ros::Publisher velocity_ual_pub = nh.advertise<geometry_msgs::TwistStamped>("ual/set_velocity",1);
     csv_trajectory_pub =nh.advertise<nav_msgs::Path>("csv_trajectory",1);
     ros::ServiceServer start_trajectory_signal = nh.advertiseService("start_shooting",startServerCallback);
+    ros::Publisher cycle_statistics_pub = nh.advertise<optimal_control_interface::CycleStatistics>("cycle_statistics",1);
     nh.getParam("path_csv", path_csv);
    
 
@@ -211,6 +170,18 @@ int main(int _argc, char **_argv)
     else {
         ROS_WARN("fail to get the drone id");
     }
+    // real-time profile of the control loop
+    Realtime::Profile profile;
+    if (ros::param::has("~realtime_priority")) {
+        ros::param::get("~realtime_priority",profile.priority);
+    }
+    if (ros::param::has("~cpus")) {
+        ros::param::get("~cpus",profile.cpus);
+    }
+    std::string profile_error;
+    if (!Realtime::apply(profile, profile_error)) {
+        ROS_WARN("Follower %d: the real-time profile can't be set (%s)", drone_id, profile_error.c_str());
+    }
 
     csv_ual.open("/home/alfonso/ual"+std::to_string(drone_id)+".csv");
     csv_record.open("/home/alfonso/record"+std::to_string(drone_id)+".csv");
@@ -218,15 +189,21 @@ int main(int _argc, char **_argv)
     csv_ual << std::fixed << std::setprecision(5);
 
     int previous_pose_on_path = 0;
+    ros::Rate control_rate(1/control_period);
+    Realtime::CycleStatistics cycle_statistics(control_period);
+    const uint64_t statistics_cycles = std::max(1L, std::lround(statistics_period/control_period));
     while(ros::ok){
-        ROS_INFO("Drone %d: waiting for trajectory. Pose on path: %d",drone_id,pose_on_path);
+        TRACE_INFO(5.0, "Drone %.0f: waiting for trajectory. Pose on path: %.0f",drone_id,pose_on_path);
         //wait for receiving trajectories
+        control_rate.reset();
+        cycle_statistics.restart();
         while((!positions.empty() && !velocities.empty())){ // if start trajectory is provided by topic or by csv
+            cycle_statistics.tick();
             csv_ual << current_pose[0] << ", " << current_pose[1] << ", " << current_pose[2] <<", "<< current_vel[0] << ", " << current_vel[1] << ", " << current_vel[2] << std::endl;
-            pose_on_path = cal_pose_on_path(positions,previous_pose_on_path);
+            pose_on_path = FollowerControl::cal_pose_on_path(positions,current_pose,previous_pose_on_path);
             previous_pose_on_path = pose_on_path;
-            ROS_INFO("Drones %d: pose on path: %d", drone_id, pose_on_path);
-            target_pose = cal_pose_look_ahead(positions,look_ahead, pose_on_path);
+            TRACE_DEBUG(0.0, "Drone %.0f: pose on path: %.0f", drone_id, pose_on_path);
+            target_pose = FollowerControl::cal_pose_look_ahead(positions,look_ahead, pose_on_path);
             // if the point to go is out of the trajectory, the trajectory will be finished and cleared
             if(target_pose==positions.size()){
                 ROS_INFO("Drone %d: end of the trajectory",drone_id);
@@ -236,10 +213,10 @@ int main(int _argc, char **_argv)
                 previous_pose_on_path = 0;
                 break;
             }
-            ROS_INFO("Drone %d: look ahead: %d",drone_id,target_pose);
+            TRACE_DEBUG(0.0, "Drone %.0f: look ahead: %.0f",drone_id,target_pose);
             Eigen::Vector3f pose_to_go =Eigen::Vector3f(positions[target_pose].pose.position.x,positions[target_pose].pose.position.y, positions[target_pose].pose.position.z);
             Eigen::Vector3f vel_to_go= Eigen::Vector3f(velocities[pose_on_path].linear.x,velocities[pose_on_path].linear.y, velocities[pose_on_path].linear.z);
-            Eigen::Vector3f velocity_to_command = calculate_vel(pose_to_go, vel_to_go);
+            Eigen::Vector3f velocity_to_command = FollowerControl::calculate_vel(pose_to_go, vel_to_go, current_pose);
             // publish topic to ual
             geometry_msgs::TwistStamped vel;
             vel.header.frame_id = "map";
@@ -247,8 +224,23 @@ int main(int _argc, char **_argv)
             vel.twist.linear.y = velocity_to_command.y();
             vel.twist.linear.z = velocity_to_command.z();
             velocity_ual_pub.publish(vel);
+            if (cycle_statistics.cycles() > 0 && cycle_statistics.cycles()%statistics_cycles == 0) {
+                optimal_control_interface::CycleStatistics statistics;
+                statistics.header.stamp = ros::Time::now();
+                statistics.nominal_period = cycle_statistics.nominalPeriod();
+                statistics.last_period = cycle_statistics.last();
+                statistics.min_period = cycle_statistics.min();
+                statistics.max_period = cycle_statistics.max();
+                statistics.mean_period = cycle_statistics.mean();
+                statistics.jitter = cycle_statistics.jitter();
+                statistics.cycles = cycle_statistics.cycles();
+                statistics.overruns = cycle_statistics.overruns();
+                statistics.bin_width = cycle_statistics.binWidth();
+                statistics.histogram.assign(cycle_statistics.histogram().begin(), cycle_statistics.histogram().end());
+                cycle_statistics_pub.publish(statistics);
+            }
             ros::spinOnce();
-            ros::Duration(0.1).sleep();
+            control_rate.sleep();
         }
         ros::spinOnce();
        ros::Duration(1).sleep();
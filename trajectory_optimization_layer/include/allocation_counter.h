@@ -0,0 +1,46 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SolverUtils{
+
+/**
+ * Heap allocations of the calling thread. They are counted only in the executables linked with the allocation interposer
+ * (allocation_interposer.cpp, COUNT_ALLOCATIONS in CMakeLists.txt), which replaces the malloc family of glibc, so every allocation of the
+ * process is seen: operator new, Eigen, ACADO and the generated C code. A part of the planning cycle can be checked to be allocation free
+ * after the warm-up. Without the interposer the counters are always 0
+ */
+class AllocationCounter{
+
+public:
+    typedef uint64_t (*Source)();
+
+    /** \brief counters of the interposer. It is called by the interposer when the executable starts */
+    static void install(const Source allocations, const Source bytes);
+    /** \brief true if the allocations are counted */
+    static bool enabled();
+    /** \brief allocations of the calling thread since it started */
+    static uint64_t allocations();
+    /** \brief bytes allocated by the calling thread since it started */
+    static uint64_t bytes();
+};
+
+/** Allocations of the calling thread since the object was created
+ */
+class AllocationScope{
+
+public:
+    AllocationScope() : allocations_(AllocationCounter::allocations()), bytes_(AllocationCounter::bytes()){}
+    uint64_t allocations() const { return AllocationCounter::allocations()-allocations_; }
+    uint64_t bytes() const { return AllocationCounter::bytes()-bytes_; }
+
+private:
+    const uint64_t allocations_;
+    const uint64_t bytes_;
+};
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef AXIS_MPC_H
+#define AXIS_MPC_H
+
+#include <dense_qp.h>
+#include <memory>
+
+namespace NumericalSolver{
+
+/** Parameters of the double integrator along one axis, with the same discretization, bounds and weights as the ACADO problem
+ */
+struct AxisParameters{
+    int time_horizon = 40;
+    double step_size = 0.2;
+    double max_vel = 1.0;
+    double max_acc = 1.0;
+    double w_acc = 1.0;  /**< weight of the accelerations */
+    double w_end = 0.1;  /**< weight of the distance to the desired position at the end of the horizon. 0 if there is no desired position along this axis */
+    bool operator==(const AxisParameters &other) const {
+        return time_horizon == other.time_horizon && step_size == other.step_size && max_vel == other.max_vel && max_acc == other.max_acc &&
+               w_acc == other.w_acc && w_end == other.w_end;
+    }
+};
+
+/** Double integrator MPC along one axis, condensed into a QP over the accelerations:
+ *      min  w_acc * sum(a_k^2) + w_end * (p_N - desired)^2
+ *      s.t. |a_k| <= max_acc, |v_k| <= max_vel
+ * with piecewise constant accelerations over the horizon. The first acceleration is fixed (initial state of the solver).
+ * The prediction matrices and the QP factorization depend only on the parameters, so they are computed once.
+ */
+class AxisMPC{
+
+public:
+    AxisMPC(const AxisParameters &parameters);
+
+    /** \brief solve the problem from the origin
+     *  \param displacement desired position relative to the initial position
+     *  \param v0 initial velocity
+     *  \param a0 initial acceleration
+     *  \param acc solved accelerations, one per step of the horizon (the last one is zero). Its value is the warm start
+     *  \return false if the initial state is not feasible or the QP did not converge
+     */
+    bool solve(const double displacement, const double v0, const double a0, Eigen::VectorXd &acc);
+    /** \brief integrate accelerations with the exact discretization of the double integrator
+     *  \param parameters horizon and step size
+     *  \param p0 initial position
+     *  \param v0 initial velocity
+     *  \param acc accelerations, one per step
+     *  \param position position at each step (output)
+     *  \param velocity velocity at each step (output)
+     */
+    static void integrate(const AxisParameters &parameters, const double p0, const double v0, const Eigen::VectorXd &acc, Eigen::VectorXd &position, Eigen::VectorXd &velocity);
+
+    const AxisParameters &parameters() const { return parameters_; }
+
+private:
+    const AxisParameters parameters_;
+    Eigen::MatrixXd gamma_v_;       /**< velocity at steps 1..N-1 with respect to the free accelerations a_1..a_N-2 */
+    Eigen::VectorXd gamma_p_end_;   /**< final position with respect to the free accelerations */
+    std::unique_ptr<DenseQP> qp_;
+    Eigen::VectorXd x_;             /**< free accelerations, last solution */
+};
+
+}
+
+#endif
@@ -1,9 +1,5 @@
 #ifndef BACKENDSOLVER_H
 #define BACKENDSOLVER_H
-#ifdef FORCES
-#include "FORCESNLPsolver.h"
-#include <FORCES_PRO.h>
-#endif
 #include <ros/ros.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/TwistStamped.h>
@@ -14,10 +10,25 @@
 #include <solver_acado.h>
 #include <shot_executer/DesiredShot.h>
 #include <optimal_control_interface/Solver.h>
+#include <optimal_control_interface/PlannerMetrics.h>
+#include <optimal_control_interface/CycleStatistics.h>
 #include <thread>  // std::thread, std::this_thread::sleep_for
+#include <mutex>
+#include <atomic>
 #include <ros/package.h>
 #include <chrono>
 #include <UAVState.h>
+#include <solution_cache.h>
+#include <problem_recorder.h>
+#include <explicit_mpc.h>
+#include <condensed_qp_solver.h>
+#include <decoupled_solver.h>
+#include <solver_backend.h>
+#include <pluginlib/class_loader.h>
+#include <trace.h>
+#include <allocation_counter.h>
+#include <realtime.h>
+#include <cycle_arena.h>
 
 #include <algorithm>
 #define ZERO 0.000001
@@ -62,8 +73,16 @@ class Logger;
 class backendSolver {
 public:
   backendSolver(ros::NodeHandle pnh, ros::NodeHandle nh, int time_horizon);
+  /*! \brief Constructor without ROS communication (no params, topics or log files). Used to run the planner offline, e.g. by the closed-loop simulator
+   *  \param time_horizon number of steps
+   *  \param solver_rate rate to call the solver (Hz)
+   *  \param drone_id own drone id
+   **/
+  backendSolver(const int time_horizon, const float solver_rate, const int drone_id);
+  ~backendSolver();
     /*! \brief If the planning is active: clean the state variables, call solver function, predict yaw and pitch, publish solved trajectories, publish data to
-    *visualize
+    *visualize. The calling thread is the solver thread: it takes the real-time profile of the params, and the callbacks are moved to their own
+    *thread if callback_thread is set
    **/
   void stateMachine();
 
@@ -94,6 +113,8 @@ protected:
   // desired pose
   const double       REACHING_TOLERANCE = 2.0; /**< Distance to the desired pose that is set as reached */
   nav_msgs::Odometry desired_odometry_;        /**< Desired pose [x y z yaw] */
+  std::vector<nav_msgs::Odometry> reference_trajectory_; /**< Desired pose at each step of the horizon. Empty if the shot does not provide it or tracking_cost_ is false */
+  bool               tracking_cost_ = true;    /**< track the shot reference along the whole horizon instead of only the desired pose at the end */
   int                desired_type_ = shot_executer::DesiredShot::IDLE;
   // solver
   float        solver_rate_        = 0.5; /**< Rate to call the solver (Hz) */  // NOT USED
@@ -102,13 +123,55 @@ protected:
   bool         target_             = true;                                      /**< true if there is a target that is being filmed*/
   const double step_size           = 0.2;                                       /**< step size (seg) */
   bool         first_time_solving_ = true;
+  bool         change_initial_guess_ = true; /**< the previous solve failed, so the initial guess is not taken from the previous solution */
   bool         height_reached_     = false; /**< utility flag to set true when the height of the shot is reached */
+  // fallback ladder, tried in order until a level gives a plan. The last levels don't call the solver, so every cycle has a plan
+  enum FallbackLevel { NOMINAL, RELAXED, SHORT_HORIZON, SHIFTED_PLAN, BRAKING, N_FALLBACK_LEVELS };
+  std::vector<double> fallback_time_budget_ = {0.5, 0.25, 0.15}; /**< time budget of the solver levels, fraction of the solver period */
+  std::vector<double> time_grid_;                                /**< times of the nodes of the solver (time_grid param). Empty: uniform */
+  bool                discrete_dynamics_ = false;                /**< exact discrete-time model in the solver (discrete_dynamics param) */
+  const double        RELAXED_TOLERANCE_SCALE = 10.0;            /**< tolerances of the relaxed levels with respect to the nominal ones */
+  int                 max_shifted_cycles_ = 3;                   /**< cycles in a row that the previous plan can be shifted before braking */
+  std::array<unsigned int, N_FALLBACK_LEVELS> fallback_count_{}; /**< cycles planned by each level */
+  unsigned int        consecutive_fallbacks_ = 0;                /**< cycles in a row without a nominal plan */
+  const float         MAX_BRAKING_ACC = 1.0;                     /**< acceleration of the braking trajectories, the bound of the solver */
+  const int           BRAKING_KEPT_POINTS = 6;                   /**< points of the previous plan kept before braking: the ones followed while planning and the start */
+  // timing of the plans. They are spliced in time, so a plan can be published as soon as it is solved
+  double              plan_start_ = 0.0;                         /**< time of the first point of the current solution (s). ROS time in the node */
+  double              expected_solve_time_ = 0.0;                /**< time from the start of a planning step to its publication (s) */
+  const double        SOLVE_TIME_DECAY = 0.9;                    /**< decay of the expected solve time when the steps are faster than it */
+  // startup. The solver is warmed up before the first shot, so the first plan takes as long as the next ones
+  const int           WARM_UP_SOLVES = 3;                        /**< dummy solves at startup. The last one is checked to be allocation free */
+  bool                lock_memory_ = false;                      /**< lock the pages of the node in RAM after the warm-up (lock_memory param) */
+  uint64_t            planning_allocations_ = 0;                 /**< heap allocations of the fallback ladder in the last cycle */
+  // real-time profile. The solver thread runs stateMachine, the callbacks run between its cycles or in their own thread
+  Realtime::Profile   solver_profile_;                           /**< scheduling of the solver thread (realtime_priority and solver_cpus params) */
+  Realtime::Profile   callback_profile_;                         /**< scheduling of the callback thread (callback_cpus param) */
+  bool                callback_thread_ = false;                  /**< run the callbacks in their own thread (callback_thread param) */
+  std::thread         callback_spinner_;                         /**< thread of the callbacks, if callback_thread_ */
+  std::atomic<bool>   stop_callbacks_{false};
+  std::mutex          inputs_mutex_;                             /**< protects received_, held by the callbacks and by copyInputs */
+  /*! Inputs written by the callbacks. The solver thread copies them to the members it plans with at the start of every cycle, so the
+   *  lock is not held during the solve and the callbacks never wait for it */
+  struct ReceivedInputs {
+    nav_msgs::Odometry              desired_odometry;
+    int                             desired_type = shot_executer::DesiredShot::IDLE;
+    std::vector<nav_msgs::Odometry> reference_trajectory;
+    std::map<int, UavState>         uavs_pose;
+    nav_msgs::Odometry              target_odometry;
+    bool                            target_has_pose = false;
+  } received_;
+  // scratch data of a cycle: predicted angles and published messages
+  static constexpr size_t CYCLE_ARENA_SIZE = 1 << 18;            /**< bytes of the arena, the MRS trajectory resampled at 0.01 s takes ~30 KB */
+  SolverUtils::CycleArena cycle_arena_{CYCLE_ARENA_SIZE};        /**< reset at the start of every cycle of stateMachine */
 
   std::vector<int> drones;
   // services and topics
   ros::Subscriber                target_array_sub;       /**< Subscriber to target topic */
   ros::Subscriber                desired_pose_sub;       /**< Subscriber to Shot executer's desired pose*/
   ros::Publisher                 solved_trajectory_pub;  /**< Publisher for the solve trajectroy for others */
+  ros::Publisher                 metrics_pub;            /**< Publisher of the fallback ladder metrics */
+  ros::Publisher                 cycle_statistics_pub;   /**< Publisher of the period of the planning cycles */
   ros::ServiceServer             service_for_activation; /**< service to activate the planning */
   std::map<int, ros::Subscriber> drone_pose_sub;         /**< subscribers of the drones poses <drone_id, pose_subscriber> */
   std::map<int, ros::Subscriber> drone_trajectory_sub;   /**< subscribers the solved trajectory of others <drone_id, trajectory_subscriber */
@@ -130,11 +193,115 @@ protected:
   std::string trajectory_frame_;
 
   bool         hovering_ = true;
-  std::unique_ptr<NumericalSolver::ACADOSolver> solver_pt_;
-  // FORCESPROsolver solver_;                /**< solver object */
+  std::unique_ptr<pluginlib::ClassLoader<NumericalSolver::SolverBackend>> solver_loader_; /**< loader of the backend plugins. It must outlive the backend */
+  boost::shared_ptr<NumericalSolver::SolverBackend> solver_pt_;   /**< NLP solver backend (param solver_backend) */
+  NumericalSolver::SolverResult                     solver_result_; /**< status and solving time of the last planning step */
+  std::unique_ptr<NumericalSolver::ExplicitMPC> explicit_mpc_; /**< lookup table for the waypoint shots. nullptr if there is no table */
+  std::unique_ptr<NumericalSolver::DecoupledSolver> decoupled_solver_; /**< per-axis solver for the legs without target. nullptr if it is not activated */
+  std::unique_ptr<SolverUtils::SolutionCache> solution_cache_; /**< cache of solved problems for repeated shots. nullptr if it is not activated */
+  std::vector<State> cached_solution_;                          /**< trajectory returned by or saved in the cache, from the initial state */
+  std::unique_ptr<SolverUtils::ProblemRecorder> problem_recorder_; /**< capture of the planning steps for replay_solver. nullptr if it is not activated */
+  NumericalSolver::SolverOptions solver_options_;               /**< options of the current solver level */
 
   bool desired_position_reached_ = false; /**< flag to check if the last generated trajectory reach the desired point */
 
+  /*! \brief One planning cycle: predict the target trajectory, calculate the initial guess and call the solver.
+   *   \param initial_time time of the initial state from the first point of the current solution (s)
+   *   \return solver status
+   **/
+  int planningStep(const float initial_time);
+
+  /*! \brief plan one cycle going down the fallback ladder: nominal solve, relaxed tolerances, shorter horizon (each one with its
+   *          time budget), previous plan shifted and braking trajectory
+   *   \param initial_time time of the initial state from the first point of the current solution (s)
+   *   \return level that produced the plan
+   **/
+  FallbackLevel fallbackLadder(const float initial_time);
+
+  /*! \brief previous plan shifted as the solver would splice it, completed braking
+   *   \return false if there is no previous plan
+   **/
+  bool shiftedPlan(const float initial_time);
+
+  /*! \brief braking trajectory from the state where the solver would start. The points followed while planning are kept
+   **/
+  void brakingPlan(const float initial_time);
+
+  /*! \brief last point of a plan shifted to start that is not after the end of the previous plan
+   **/
+  int lastShiftedPoint(const double start) const;
+
+  /*! \brief time of the initial state of a plan that starts to be followed at start_time. 0 the first time
+   *   \param start_time time when the new plan is published (s)
+   **/
+  float initialTime(const double start_time) const;
+
+  /*! \brief move plan_start_ to the first point of the plan that has just been saved in the solution of the backend
+   *   \param now time when the planning step started (s). The first plan starts there, from the uav pose
+   *   \param initial_time time of the initial state of the planning step
+   **/
+  void updatePlanStart(const double now, const float initial_time);
+
+  /*! \brief publish the metrics of the fallback ladder
+   **/
+  void publishMetrics(const FallbackLevel level, const double planning_time);
+
+  /*! \brief publish the period of the planning cycles
+   **/
+  void publishCycleStatistics(const Realtime::CycleStatistics &statistics);
+
+  /*! \brief copy the inputs received by the callbacks to the ones of the cycle. The caller holds inputs_mutex_
+   **/
+  void copyInputs();
+
+  /*! \brief apply the real-time profile to the calling thread, the solver one, and start the callback thread if it is set
+   **/
+  void startThreads();
+
+  /*! \brief solve a representative shot with every solver before the first one is commanded: the lazy allocations, the first page faults
+   *          and the setup of the solvers are done here. The buffers of the cycle are sized for the horizon. The state of the planner
+   *          is not changed, the first cycle still starts from the uav pose
+   *   \return heap allocations of the last warm-up solve, it must be 0. Always 0 without the allocation interposer
+   **/
+  uint64_t warmUp();
+
+  /*! \brief save the input of the solver in a record of the problem recorder. It is called right before the solver that answers runs,
+   *         once the initial guess is final
+   *   \param initial_time time of the initial state from the first point of the current solution (s)
+   **/
+  void captureProblem(SolverUtils::ProblemRecorder::Record &record, const float initial_time);
+
+  /*! \brief describe the problem of this cycle for the solution cache
+   *   \param initial_time time of the initial state from the first point of the current solution (s)
+   **/
+  SolverUtils::SolutionCache::Features cacheFeatures(const float initial_time);
+
+  /*! \brief point of the current solution where the initial state of a planning step is, as the solvers splice their solutions
+   *   \param initial_time time of the initial state from the first point of the current solution (s)
+   **/
+  int initialPoint(const float initial_time) const;
+
+  /*! \brief save the solution of the solver in the cache, from the initial state of the problem
+   **/
+  void cacheSolution(const SolverUtils::SolutionCache::Features &features, const float initial_time);
+
+  /*! \brief translate the trajectory returned by the cache to the initial state of the problem
+   **/
+  void anchorCachedSolution(const SolverUtils::SolutionCache::Features &features);
+
+  /*! \brief splice the trajectory returned by the cache with the current solution, as a solver would do with its solution
+   *   \param initial_time time of the initial state from the first point of the current solution (s)
+   **/
+  void spliceCachedSolution(const float initial_time);
+
+  /*! \brief call a fast solver that only covers part of the problems. It starts from the current solution of the NLP solver, and its
+   *         solution is copied to the NLP solver if it succeeds
+   *   \param initial_time time of the initial state from the first point of the current solution (s)
+   *   \param record record of the problem recorder, filled if the fast solver succeeds. nullptr: the step is not captured
+   *   \return true if the fast solver solved the problem
+   **/
+  bool fastSolve(NumericalSolver::Solver &fast_solver, const float initial_time, SolverUtils::ProblemRecorder::Record *record);
+
   /** \brief This function save the trajectory calculated by the solver **/
 
   void saveCalculatedTrajectory();
@@ -143,11 +310,6 @@ protected:
    *   \return closest point of the trajectory
    */
   int closestPose();
-  /*! \brief utility function to calculate the delay of solving
-   *   \param start time to call the solver
-   *   \return number of points of the calculated trajectory that are delayed
-   */
-  float checkRoundedTime(std::chrono::system_clock::time_point start);
   /*! \brief Utility function to erase the points that are delayed
    *   \param number_of_points that are delayed
    */
@@ -178,13 +340,13 @@ protected:
 
   //////////////// UTILITY FUNCTION ////////////////////////////////
   /*! \brief This function calculates the pitch of the camera over the N steps through calculated trajectroy and target trajectory
-   *   \return Predicted pitch
+   *   \return Predicted pitch, in the cycle arena
    **/
-  std::vector<double> predictingPitch();
+  SolverUtils::ArenaVector<double> predictingPitch();
   /*! \brief This function calculates the yaw of the drone over the N steps (pointing to the target) through calculated trajectory and target trajectory
-   *   \return Predicted yaw over N steps
+   *   \return Predicted yaw over N steps, in the cycle arena
    **/
-  std::vector<double> predictingYaw();
+  SolverUtils::ArenaVector<double> predictingYaw();
 
   /** \brief Utility function to predict the trajectory of the target along the N steps. This function use a velocity cte model to predict the target trajectory
    *  \TODO Predict target trajectory with actual pose and velocity
@@ -204,9 +366,9 @@ protected:
   bool checkConnectivity();
 
 
-  /*! \brief publish the solved trajectory for others
+  /*! \brief publish the solved trajectory for others. The points are stamped from plan_start_. The messages are built in the cycle arena
    **/
-  virtual void publishSolvedTrajectory(const std::vector<double> &yaw, const std::vector<double> &pitch, const int delayed_points = 0);
+  virtual void publishSolvedTrajectory(const SolverUtils::ArenaVector<double> &yaw, const SolverUtils::ArenaVector<double> &pitch);
 
   /** \brief Utility function to calculate if the trajectory calculated by the solver finishes in the desired pose
    *  \param desired_pos      This is the desired pose
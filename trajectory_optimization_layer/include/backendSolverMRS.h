@@ -6,6 +6,7 @@
 #include <mrs_msgs/TrajectoryReference.h>
 #include <mrs_msgs/Reference.h>
 #include <mrs_lib/transformer.h>
+#include <trajectory_resampler.h>
 
 class backendSolverMRS : public backendSolver {
 public:
@@ -13,6 +14,7 @@ public:
 
 private:
   mrs_lib::Transformer transformer_;
+  std::unique_ptr<SolverUtils::TrajectoryResampler> resampler_; /**< solution at the rate of the MRS tracker (output_step param) */
 
   ros::Subscriber uav_odometry_sub; /**< Subscriber to UAV's odometry*/
   ros::Publisher  diagnostics_pub;
@@ -31,7 +33,7 @@ private:
    **/
   bool activationServiceCallback(std_srvs::SetBool::Request &req, std_srvs::SetBool::Response &res);
   void uavCallback(const nav_msgs::Odometry::ConstPtr &msg);
-  void publishSolvedTrajectory(const std::vector<double> &yaw, const std::vector<double> &pitch, const int delayed_points = 0);
+  void publishSolvedTrajectory(const SolverUtils::ArenaVector<double> &yaw, const SolverUtils::ArenaVector<double> &pitch);
   void diagTimer(const ros::TimerEvent &event);
 
   void publishTargetOdometry();
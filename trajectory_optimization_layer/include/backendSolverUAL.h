@@ -22,7 +22,7 @@ private:
   */
   void uavPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &msg);
   
-  void publishSolvedTrajectory(const std::vector<double> &yaw, const std::vector<double> &pitch, const int delayed_points = 0);
+  void publishSolvedTrajectory(const SolverUtils::ArenaVector<double> &yaw, const SolverUtils::ArenaVector<double> &pitch);
 
 
 };
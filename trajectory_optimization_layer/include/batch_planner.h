@@ -0,0 +1,113 @@
+#ifndef BATCH_PLANNER_H
+#define BATCH_PLANNER_H
+
+#include <simulator.h>
+#include <UAVState.h>
+#include <Eigen/Eigen>
+#include <string>
+#include <vector>
+
+/** Offline planner for rehearsed shots. It plans a whole mission (sequence of shots over a known target path) chaining
+ * receding-horizon solves of the same solver used online, and writes the trajectory files that the trajectory follower
+ * reads in startServerCallback (<path>_positions.csv and <path>_vels.csv).
+ *
+ * Every shot is a segment. The segments are solved in parallel, each one starting at the pose where the previous shot
+ * should end. Then the segments are stitched in order and a segment is solved again from the real end of the previous one
+ * if they do not match.
+ *
+ * Mission file, one entry per line, '#' for comments:
+ *      uav x y z                        initial pose of the uav
+ *      target t x y z                   waypoint of the target path at time t (s), linear interpolation between waypoints
+ *      no_fly_zone x y                  center of the no fly zone
+ *      shot type duration x y z         shot (GOTO, ESTABLISH, FOLLOW, FLYOVER or ELEVATOR), duration (s) and rt_parameters
+ **/
+namespace BatchPlanning{
+
+/** Shot of the mission
+ */
+struct MissionShot{
+    ShotExecuter::shooting_action action;
+    double duration = 0.0; /**< planned time of the shot (s) */
+};
+
+/** Mission to plan
+ */
+struct Mission{
+    Eigen::Vector3d uav_initial_position = Eigen::Vector3d::Zero();
+    std::vector<std::pair<double, Eigen::Vector3d>> target_waypoints; /**< <time, position> sorted by time */
+    std::vector<float> no_fly_zone;                                   /**< [x y] or empty */
+    std::vector<MissionShot> shots;
+};
+
+/** \brief read a mission file
+ *  \param path mission file
+ *  \param mission output
+ *  \return false if the file can't be opened or a line is not valid
+ */
+bool readMission(const std::string &path, Mission &mission);
+
+/** \brief target odometry at time t from the target waypoints. The target stays at the last waypoint
+ */
+nav_msgs::Odometry targetOdometry(const Mission &mission, const double t);
+
+/** Planned trajectory of a segment
+ */
+struct SegmentResult{
+    bool success = false;
+    int solver_calls = 0;
+    int solver_failures = 0;
+    std::vector<State> states; /**< one state every step_size_ */
+    State end;                 /**< state where the next segment starts */
+};
+
+/** Batch planner
+ */
+class BatchPlanner{
+public:
+    BatchPlanner(const Mission &mission, const int time_horizon = 40, const float solver_rate = 1.0);
+    /** \brief plan the whole mission
+     *  \param jobs maximum number of segments solved at the same time
+     *  \return true if every segment has been planned
+     */
+    bool plan(const int jobs);
+    /** \brief write the planned trajectory in the format of the trajectory follower
+     *  \param path files <path>_positions.csv and <path>_vels.csv are written
+     *  \return false if the files can't be written
+     */
+    bool writeFollowerFiles(const std::string &path) const;
+    /** \brief planned mission, one state every step_size_
+     */
+    const std::vector<State> &trajectory() const { return trajectory_; }
+
+    int max_retries_ = 5;          /**< solver calls of the same cycle before giving up, as the retry loop of backendSolver::stateMachine */
+    double stitch_tolerance_ = 1.0; /**< distance (m) between the end of a segment and the start of the next one to solve the next one again */
+
+private:
+    /** \brief plan one shot with receding-horizon solves, as the online node but without waiting
+     *  \param shot index of the shot
+     *  \param start_time mission time where the shot starts (s)
+     *  \param start uav position at the start of the shot
+     *  \param last true if it is the last shot. Then the whole last solution is kept
+     *  \return planned segment
+     */
+    SegmentResult planSegment(const int shot, const double start_time, const Eigen::Vector3d &start, const bool last) const;
+    /** \brief pose where the shot should leave the uav at the end of it. Initial guess of the start of the next segment
+     *  \param shot index of the shot
+     *  \param end_time mission time where the shot ends (s)
+     *  \param start uav position at the start of the shot
+     */
+    Eigen::Vector3d shotEndPosition(const int shot, const double end_time, const Eigen::Vector3d &start) const;
+    /** \brief solve the segments in child processes. ACADO keeps static counters, so solves in threads of the same process interfere
+     */
+    std::vector<SegmentResult> planSegmentsInParallel(const std::vector<double> &start_times, const std::vector<Eigen::Vector3d> &starts, const int jobs) const;
+
+    const Mission mission_;
+    const int time_horizon_;
+    const float solver_rate_;     /**< rate of the receding-horizon solves in mission time (Hz) */
+    const float step_size_ = 0.2; /**< step size of the solver (s) */
+    std::vector<State> trajectory_;
+};
+
+}
+
+#endif
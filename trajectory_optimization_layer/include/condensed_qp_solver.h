@@ -0,0 +1,63 @@
+#ifndef CONDENSED_QP_SOLVER_H
+#define CONDENSED_QP_SOLVER_H
+
+#include <solver.h>
+#include <solver_backend.h>
+#include <dense_qp.h>
+#include <array>
+#include <map>
+
+namespace NumericalSolver{
+
+/** Same problem as the ACADO solver, condensed into a dense QP. The dynamics are linear, so the states are affine functions of the
+ * initial velocity and the accelerations, and the decision variables are
+ *      [v0 (3) | a_1..a_N-2 of x, y and z | slack of the height constraint (N)]
+ * a_0 is fixed by the initial state, a_N-1 does not change the states and the initial velocity is only free the first time, as in ACADO.
+ * The prediction matrices and the constraint matrix only depend on the horizon, so they are computed once per solved horizon.
+ * The camera pitch term is the only nonlinear one: it is linearized (Gauss-Newton) around the last trajectory and the QP is solved
+ * again until the trajectory does not change (SQP).
+ * The horizon of the options is solved and the rest of the horizon brakes, as in the ACADO solver. The time grid is not used.
+ */
+class CondensedQPSolver : public Solver{
+
+public:
+    static const int QP_NOT_CONVERGED = -1;
+
+    CondensedQPSolver(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess);
+
+    int solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position = 0, bool first_time_solving = true, const int _drone_id = 1, const bool _target = true, const bool _multi = false);
+
+    static constexpr double QP_TOLERANCE = 1e-3;  /**< nominal tolerance of the ADMM residuals */
+    int max_sqp_iterations_ = 5;
+    double sqp_tolerance_ = 1e-2;  /**< max change of the positions to stop the SQP (m) */
+    int qp_iterations_ = 0;        /**< ADMM iterations of the last solve, all the SQP iterations */
+
+private:
+    /** condensed QP of a horizon of N steps */
+    struct Problem{
+        int velocityIndex(const int axis) const { return axis; }
+        int accIndex(const int axis, const int k) const { return 3 + axis*n_acc + k - 1; }  // k = 1..N-2
+        int slackIndex(const int k) const { return 3 + 3*n_acc + k; }
+
+        int n_acc;                                  /**< free accelerations per axis */
+        int n;                                      /**< decision variables */
+        std::array<Eigen::MatrixXd, 3> position;    /**< positions of each axis with respect to the variables (without the initial state) */
+        std::array<Eigen::MatrixXd, 3> velocity;    /**< velocities of each axis with respect to the variables */
+        Eigen::MatrixXd hessian_fixed;              /**< accelerations, slack and end terms */
+        Eigen::MatrixXd hessian_reference;          /**< tracking of the reference trajectory */
+        std::unique_ptr<DenseQP> qp;
+        Eigen::VectorXd x;                          /**< last solution */
+    };
+
+    /** \brief condensed QP of the horizon, computed the first time it is solved
+     */
+    Problem &condensed(const int N);
+
+    std::map<int, std::unique_ptr<Problem>> problems_;  /**< by horizon: the fallback ladder alternates the whole horizon and a shorter one */
+};
+
+typedef SolverPlugin<CondensedQPSolver> CondensedQPBackend;
+
+}
+
+#endif
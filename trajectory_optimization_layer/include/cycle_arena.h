@@ -0,0 +1,71 @@
+#ifndef CYCLE_ARENA_H
+#define CYCLE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace SolverUtils{
+
+/** Allocator of the containers in a CycleArena. It is a polymorphic allocator with the rebind of the pre C++17 allocators, so it is also
+ *  the ContainerAllocator of the ROS messages (e.g. nav_msgs::Path_<ArenaAllocator<void>>), which can be published as the plain ones
+ */
+template<class T>
+class ArenaAllocator : public std::pmr::polymorphic_allocator<T>{
+
+public:
+    template<class U>
+    struct rebind{ typedef ArenaAllocator<U> other; };
+
+    ArenaAllocator(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) : std::pmr::polymorphic_allocator<T>(resource){}
+    template<class U>
+    ArenaAllocator(const std::pmr::polymorphic_allocator<U> &other) : std::pmr::polymorphic_allocator<T>(other.resource()){}
+};
+
+template<class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/** Memory of the scratch data of a planning cycle: the predicted angles and the messages that are published. The allocations take the
+ *  next bytes of a buffer and the deallocations do nothing, until reset() gives back the whole buffer at the start of the next cycle. So
+ *  the cycle does not call malloc nor fragments the heap. Everything allocated in a cycle must be destroyed before the reset.
+ *  If a cycle needs more than the buffer, the rest is taken from the heap until the reset, and counted in overflows()
+ */
+class CycleArena{
+
+public:
+    /** \param size bytes of the buffer. They are written, so the pages are mapped before the first cycle */
+    explicit CycleArena(const size_t size);
+    CycleArena(const CycleArena &) = delete;
+    CycleArena &operator=(const CycleArena &) = delete;
+
+    /** \brief free everything allocated since the last reset */
+    void reset();
+
+    std::pmr::memory_resource *resource() { return &arena_; }
+    template<class T>
+    ArenaAllocator<T> allocator() { return ArenaAllocator<T>(&arena_); }
+
+    /** \brief allocations that did not fit in the buffer since the start */
+    uint64_t overflows() const { return upstream_.allocations; }
+    size_t size() const { return buffer_.size(); }
+
+private:
+    /** heap after the buffer, counted */
+    struct Upstream : public std::pmr::memory_resource{
+        uint64_t allocations = 0;
+
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+    };
+
+    std::vector<std::byte> buffer_;
+    Upstream upstream_;
+    std::pmr::monotonic_buffer_resource arena_;
+};
+
+}
+
+#endif
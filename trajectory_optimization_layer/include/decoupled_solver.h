@@ -0,0 +1,41 @@
+#ifndef DECOUPLED_SOLVER_H
+#define DECOUPLED_SOLVER_H
+
+#include <solver.h>
+#include <axis_mpc.h>
+#include <array>
+
+namespace NumericalSolver{
+
+/** Fast path for the transit legs. Without target (no camera pitch term and no height constraint over it) and without reference
+ * trajectory, the problem is three independent double integrators with their own bounds, so it is solved as three 1D QPs (AxisMPC),
+ * one after the other in the calling thread.
+ *
+ * solverFunction returns COUPLED when the coupling terms are active, and the caller solves the problem with the NLP solver.
+ */
+class DecoupledSolver : public Solver{
+
+public:
+    static const int COUPLED = -1;
+    static const int AXIS_NOT_SOLVED = -2;
+
+    DecoupledSolver(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess);
+
+    /** \brief true if the problem is separable by axes: there is no target and no reference trajectory */
+    static bool isDecoupled(const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, const bool _target);
+
+    /** \brief solve the three axes
+     *  \return SUCCESSFUL_RETURN, COUPLED, or AXIS_NOT_SOLVED if the initial state is out of the bounds or a QP did not converge
+     */
+    int solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position = 0, bool first_time_solving = true, const int _drone_id = 1, const bool _target = true, const bool _multi = false);
+
+private:
+    std::array<std::unique_ptr<AxisMPC>, 3> axes_;
+    std::array<Eigen::VectorXd, 3> acc_;  /**< last accelerations of each axis, warm start of the next solve */
+    std::array<Eigen::VectorXd, 3> position_, velocity_;  /**< buffers of the integrated axes, so a solve does not allocate */
+    std::vector<State> grid_solution_;    /**< solution on the solver grid before setSolution */
+};
+
+}
+
+#endif
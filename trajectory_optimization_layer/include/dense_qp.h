@@ -0,0 +1,53 @@
+#ifndef DENSE_QP_H
+#define DENSE_QP_H
+
+#include <Eigen/Eigen>
+
+namespace NumericalSolver{
+
+/** Small dense QP solved with ADMM:
+ *      min 1/2 x'Px + q'x   subject to   l <= Ax <= u
+ * A is fixed when the object is created. The linear system of the iterations is only factorized again when the penalty is adapted
+ * or the hessian is changed. q, l and u can change in every solve.
+ */
+class DenseQP{
+
+public:
+    /** \param P hessian (positive semidefinite)
+     *  \param A constraint matrix
+     *  \param rho initial ADMM penalty
+     *  \param sigma regularization of the hessian
+     */
+    DenseQP(const Eigen::MatrixXd &P, const Eigen::MatrixXd &A, const double rho = 1.0, const double sigma = 1e-6);
+
+    /** \brief solve the QP
+     *  \param q linear cost
+     *  \param l lower bounds of Ax
+     *  \param u upper bounds of Ax
+     *  \param x solution. Its value is the warm start if it has the right size
+     *  \return number of iterations, -1 if it did not converge
+     */
+    int solve(const Eigen::VectorXd &q, const Eigen::VectorXd &l, const Eigen::VectorXd &u, Eigen::VectorXd &x);
+    /** \brief change the hessian (e.g. in every iteration of an SQP). The linear system is factorized again
+     */
+    void setHessian(const Eigen::MatrixXd &P);
+
+    int max_iterations_ = 4000;
+    double tolerance_ = 1e-6; /**< primal and dual residual to stop (inf norm) */
+
+private:
+    Eigen::MatrixXd P_;
+    const Eigen::MatrixXd A_;
+    const Eigen::MatrixXd AtA_;
+    double rho_;                      /**< ADMM penalty. It is adapted to balance primal and dual residuals */
+    const double sigma_;
+    static const int RHO_UPDATE_ITERATIONS = 25;
+    static const int CHECK_ITERATIONS = 5;  /**< iterations between the checks of the residuals. RHO_UPDATE_ITERATIONS must be a multiple */
+    Eigen::LLT<Eigen::MatrixXd> kkt_; /**< factorization of P + sigma I + rho A'A */
+    Eigen::VectorXd z_;               /**< Ax projected on the bounds */
+    Eigen::VectorXd y_;               /**< multipliers */
+};
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef EXPLICIT_MPC_H
+#define EXPLICIT_MPC_H
+
+#include <solver.h>
+#include <axis_mpc.h>
+#include <array>
+#include <string>
+
+namespace NumericalSolver{
+
+/** Explicit MPC for the waypoint shots (GOTO and ESTABLISH). Without reference trajectory and with the height constraint inactive,
+ * the problem is three independent double integrators, and the solution of each one only depends on
+ * (desired displacement, initial velocity, initial acceleration). The accelerations are precomputed offline on a grid of that box
+ * (explicit_mpc_generator) and interpolated online in microseconds. The interpolation of feasible solutions is feasible because the
+ * constraints are linear. The pitch term of the ACADO problem is not included.
+ *
+ * solverFunction returns OUT_OF_DOMAIN when the problem is out of the table or the height constraint would be active, and the caller
+ * solves it with the NLP solver.
+ */
+class ExplicitMPC : public Solver{
+
+public:
+    static const int OUT_OF_DOMAIN = -1;
+
+    /** Uniform grid of one table dimension
+     */
+    struct Range{
+        double min = 0.0;
+        double max = 0.0;
+        int points = 1;
+        double value(const int i) const { return points > 1 ? min + (max - min) * i / (points - 1) : min; }
+    };
+
+    ExplicitMPC(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess);
+
+    /** \brief precompute the tables of the three axes
+     *  \param displacement range of desired displacement in x and y (m). z has no desired position in the problem
+     *  \param velocity_points grid points between -max_vel and max_vel
+     *  \param acceleration_points grid points between -max_acc and max_acc
+     *  \return number of grid points that could not be solved (initial state out of the constraints)
+     */
+    int generate(const Range &displacement, const int velocity_points = 21, const int acceleration_points = 9);
+    /** \brief save the tables in a binary file */
+    bool save(const std::string &path) const;
+    /** \brief load the tables of a file generated with the same horizon, bounds and weights
+     *  \return false if the file can't be read or it was generated for another problem
+     */
+    bool load(const std::string &path);
+    bool isLoaded() const { return loaded_; }
+
+    /** \brief evaluate the tables for the waypoint shots
+     *  \return SUCCESSFUL_RETURN or OUT_OF_DOMAIN
+     */
+    int solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position = 0, bool first_time_solving = true, const int _drone_id = 1, const bool _target = true, const bool _multi = false);
+
+private:
+    /** Precomputed accelerations of one axis
+     */
+    struct AxisTable{
+        AxisParameters parameters;
+        Range displacement;
+        Range velocity;
+        Range acceleration;
+        std::vector<float> acc;       /**< time_horizon accelerations for every grid point */
+        std::vector<uint8_t> valid;   /**< the grid point was solved */
+        int index(const int d, const int v, const int a) const { return (d * velocity.points + v) * acceleration.points + a; }
+    };
+
+    /** \brief parameters of an axis as in the ACADO problem */
+    AxisParameters axisParameters(const int axis) const;
+    /** \brief interpolate the accelerations of a table
+     *  \return false if the point is out of the table or a neighbour is not valid
+     */
+    bool interpolate(const AxisTable &table, const double displacement, const double v0, const double a0, Eigen::VectorXd &acc) const;
+
+    std::array<AxisTable, 3> tables_;
+    bool loaded_ = false;
+    static const int FILE_VERSION = 1;
+};
+
+}
+
+#endif
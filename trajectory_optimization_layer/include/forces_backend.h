@@ -0,0 +1,95 @@
+#ifndef FORCES_BACKEND_H
+#define FORCES_BACKEND_H
+
+#include <solver_backend.h>
+#include <forces_models.h>
+
+namespace NumericalSolver{
+
+/** A generated solver of the FORCES backend, with its measured solving time
+ */
+class ForcesVariant{
+
+public:
+    virtual ~ForcesVariant(){}
+    virtual const char *name() const = 0;
+    virtual int horizon() const = 0;
+    /** \brief the problem has the inputs of the features of the model */
+    virtual bool accepts(const SolverProblem &problem) const = 0;
+    /** \brief see ForcesFrontEnd::solve */
+    virtual int solve(const State &initial_state, const State initial_guess[], const SolverProblem &problem, State solution[]) = 0;
+    /** \brief counters of ForcesStageEvaluator */
+    virtual int aheadSweeps() const = 0;
+    virtual int serialStages() const = 0;
+
+    double mean_time = 0.0;  /**< filtered solving time (s) */
+    int solves = 0;
+};
+
+template<class Model>
+class ForcesModelVariant : public ForcesVariant{
+
+public:
+    explicit ForcesModelVariant(StagePool &pool) : front_end_(pool){}
+    const char *name() const override{ return Model::NAME; }
+    int horizon() const override{ return Model::HORIZON; }
+    bool accepts(const SolverProblem &problem) const override{
+        typedef typename ForcesFrontEnd<Model>::Parameters Parameters;
+        return (!Parameters::TARGET || (problem.target && !problem.target_trajectory.empty())) && (!Parameters::NO_FLY_ZONE || problem.no_fly_zone.size() == 2);
+    }
+    int solve(const State &initial_state, const State initial_guess[], const SolverProblem &problem, State solution[]) override{
+        return front_end_.solve(initial_state, initial_guess, problem, solution);
+    }
+    int aheadSweeps() const override{ return front_end_.evaluator().ahead_sweeps_; }
+    int serialStages() const override{ return front_end_.evaluator().serial_stages_; }
+
+private:
+    ForcesFrontEnd<Model> front_end_;
+};
+
+/** Backend of the FORCES PRO solvers. There is a generated solver for every horizon of forces_models.h, and the one of every cycle is
+ * chosen with the problem and the options:
+ *      - look-ahead: the target shots need the whole horizon, the waypoint shots only the steps to reach the goal at the max velocity. The
+ *        horizon of the options (fallback ladder) limits it.
+ *      - latency: the solvers whose mean solving time is over the time budget of the options are not used.
+ * The shortest solver with the look-ahead is used, or the longest one if none has it. The solution is cut or completed braking to the
+ * time horizon. It always starts from the uav pose and its status is the FORCES exitflag (1: optimal solution)
+ * The stages of the solvers are evaluated in ~forces_evaluation_threads threads besides the solving one. By default (0) they are evaluated
+ * serially: a sweep of the 40 stages of the target model takes a few microseconds, less than waking the threads
+ */
+class ForcesBackend : public SolverBackend{
+
+public:
+    static constexpr double STEP_SIZE = 0.2;
+    static constexpr double MAX_VEL = 1.0;   /**< velocity bound of the generated models (m/s) */
+    static constexpr double MAX_ACC = 1.0;
+    static const int MIN_STAGES_PER_THREAD = 10;  /**< a thread of the evaluation of the stages takes at least these stages */
+
+    void initialize(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess) override;
+    SolverResult solve(SolverProblem &problem) override;
+    void setOptions(const SolverOptions &options) override{ options_ = options; }
+    State *solution() override{ return solution_.get(); }
+    State initialState(std::map<int,UavState> &uavs_pose, const float time_initial_position, const bool first_time_solving, const int drone_id) const override{
+        return uavs_pose.at(drone_id).state;
+    }
+    // nothing is spliced, the uav pose is taken as the state at the initial time
+    double solutionStart(const float time_initial_position) const override{ return time_initial_position; }
+
+private:
+    /** \brief generated solver of the cycle, nullptr if none accepts the problem */
+    ForcesVariant *select(const SolverProblem &problem) const;
+
+    std::unique_ptr<StagePool> pool_;                       /**< evaluation of the stages, shared by the solvers */
+    std::vector<std::unique_ptr<ForcesVariant>> variants_;  /**< sorted by horizon */
+    int time_horizon_ = 0;
+    SolverOptions options_;
+    std::shared_ptr<State[]> initial_guess_;
+    std::unique_ptr<State[]> solution_;
+    std::vector<State> variant_guess_, variant_solution_;  /**< as long as the longest horizon */
+    // the initial acceleration of the next solve is the one of the last solution at the time it is started
+    std::chrono::steady_clock::time_point last_solve_;
+};
+
+}
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef FORCES_FRONT_END_H
+#define FORCES_FRONT_END_H
+
+#include <solver_backend.h>
+#include <forces_stage_evaluator.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <utility>
+
+/** Traits of a generated solver, declared after including its header. FORCES prefixes all the symbols with the name of the solver, so the
+ *  solvers generated with different names (getOptions('<name>') in setup_solver_*.m) are linked together
+ *  \param name name of the solver
+ *  \param horizon stages of the model
+ *  \param features ForcesFeature the model was generated with
+ */
+#define FORCES_GENERATED_MODEL(name, horizon, features)                                                                                  \
+    extern "C" void name##_casadi2forces(name##_float *x, name##_float *y, name##_float *l, name##_float *p, name##_float *f,             \
+                                         name##_float *nabla_f, name##_float *c, name##_float *nabla_c, name##_float *h,                 \
+                                         name##_float *nabla_h, name##_float *H, solver_int32_default stage,                              \
+                                         solver_int32_default iteration);                                                                 \
+    namespace NumericalSolver{                                                                                                            \
+    struct name##_model{                                                                                                                  \
+        typedef name##_float Float;                                                                                                       \
+        typedef name##_params Params;                                                                                                     \
+        typedef name##_output Output;                                                                                                     \
+        typedef name##_info Info;                                                                                                         \
+        typedef name##_extfunc Callback;                                                                                                  \
+        static constexpr const char *NAME = #name;                                                                                       \
+        static constexpr int HORIZON = horizon;                                                                                           \
+        static constexpr unsigned FEATURES = features;                                                                                    \
+        static void evaluate(Float *x, Float *y, Float *l, Float *p, Float *f, Float *nabla_f, Float *c, Float *nabla_c, Float *h,       \
+                             Float *nabla_h, Float *hess, solver_int32_default stage, solver_int32_default iteration){                   \
+            name##_casadi2forces(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, hess, stage, iteration);                               \
+        }                                                                                                                                 \
+        static int solve(Params *params, Output *output, Info *info, Callback callback){ return name##_solve(params, output, info, stdout, callback); } \
+    };                                                                                                                                    \
+    }
+
+namespace NumericalSolver{
+
+/** Constraint sets a FORCES model can be generated with. Each one adds its parameters to every stage */
+enum ForcesFeature : unsigned{
+    FORCES_TARGET = 1u,       /**< camera pitch to the target */
+    FORCES_MULTI = 2u,        /**< distance to two other uavs */
+    FORCES_NO_FLY_ZONE = 4u   /**< distance to an obstacle */
+};
+
+/** Parameters of a stage of a generated model, in the order of setup_solver_*.m. The offsets are constant expressions of the features,
+ *  so the packing is fixed at compile time
+ */
+template<unsigned Features>
+struct ForcesParameterLayout{
+    static constexpr bool TARGET = Features & FORCES_TARGET;
+    static constexpr bool MULTI = Features & FORCES_MULTI;
+    static constexpr bool NO_FLY_ZONE = Features & FORCES_NO_FLY_ZONE;
+    static constexpr int OTHER_UAVS = 2;
+    static constexpr int DESIRED_POSITION = 0;                                  /**< x, y, z */
+    static constexpr int DESIRED_VELOCITY = 3;                                  /**< x, y, z */
+    static constexpr int TARGET_VELOCITY = 6;                                   /**< x, y */
+    static constexpr int TARGET_POSITION = TARGET_VELOCITY + (TARGET ? 2 : 0);  /**< x, y */
+    static constexpr int UAVS = TARGET_POSITION + (TARGET ? 2 : 0);             /**< x, y of every other uav */
+    static constexpr int OBSTACLE = UAVS + (MULTI ? 2*OTHER_UAVS : 0);          /**< x, y */
+    static constexpr int SIZE = OBSTACLE + (NO_FLY_ZONE ? 2 : 0);
+};
+
+/** Variables of a stage: [ax ay az px py pz vx vy vz] */
+struct ForcesVariableLayout{
+    static constexpr int ACC = 0;
+    static constexpr int POSITION = 3;
+    static constexpr int VELOCITY = 6;
+    static constexpr int SIZE = 9;
+};
+
+/** Sizes of the functions of a stage, for the buffers of ForcesStageEvaluator. They are upper bounds: the last stage has no dynamics */
+template<unsigned Features>
+struct ForcesStageLayout{
+    typedef ForcesParameterLayout<Features> Parameters;
+    static constexpr int NVAR = ForcesVariableLayout::SIZE;
+    static constexpr int NPAR = Parameters::SIZE;
+    static constexpr int NEQ = 6;  /**< position and velocity */
+    static constexpr int NH = (Parameters::TARGET ? 1 : 0) + (Parameters::MULTI ? Parameters::OTHER_UAVS : 0) + (Parameters::NO_FLY_ZONE ? 1 : 0);  /**< pitch, distance to every uav and to the obstacle */
+};
+
+/** Front-end of a generated FORCES solver (FORCES_GENERATED_MODEL), for its horizon and features. The layouts are checked against the generated header,
+ *  so a model generated with another horizon or other parameters does not compile instead of reading misaligned parameters.
+ *  The stages are packed and unpacked with a fold over the horizon, without loops nor branches on the features. The external functions
+ *  of the stages are evaluated in parallel by ForcesStageEvaluator.
+ *  The other uavs of the multi models are static obstacles at their current position.
+ *  The generated model plans at a fixed height: the height of the initial state and of the desired pose is PLANNING_HEIGHT, and the
+ *  solution keeps the height of the initial state.
+ */
+template<class Model>
+class ForcesFrontEnd{
+
+public:
+    typedef ForcesParameterLayout<Model::FEATURES> Parameters;
+    typedef ForcesVariableLayout Variables;
+    typedef typename Model::Float Float;
+    typedef ForcesStageEvaluator<Model, ForcesStageLayout<Model::FEATURES>> Evaluator;
+    static constexpr int HORIZON = Model::HORIZON;
+    static constexpr double PLANNING_HEIGHT = 3.0;
+
+    /** \param pool threads of the evaluation of the stages */
+    explicit ForcesFrontEnd(StagePool &pool) : evaluator_(pool){}
+
+    static_assert(sizeof(Model::Params::all_parameters) == sizeof(Float)*HORIZON*Parameters::SIZE,
+                  "the parameter layout does not match the generated solver (horizon or features)");
+    static_assert(sizeof(Model::Params::x0) == sizeof(Float)*HORIZON*Variables::SIZE,
+                  "the initial guess does not match the generated solver");
+    static_assert(sizeof(Model::Params::xinit) == sizeof(Float)*Variables::SIZE,
+                  "the initial state does not match the generated solver");
+    static_assert(sizeof(typename Model::Output) == sizeof(Float)*HORIZON*Variables::SIZE,
+                  "the output of the generated solver must be the stages one after another");
+
+    /** \brief pack the problem, solve it and unpack the solution
+     *  \param initial_state state of the first stage. Its acceleration is the one being followed
+     *  \param initial_guess HORIZON states
+     *  \param problem the target trajectory is held at its last point if it is shorter than the horizon. It must not be empty if the
+     *         model has a target, nor the no fly zone if the model has it
+     *  \param solution output, HORIZON states
+     *  \return FORCES exitflag (1: optimal solution)
+     */
+    int solve(const State &initial_state, const State initial_guess[], const SolverProblem &problem, State solution[]){
+        setVariables(params_.xinit, initial_state);
+        params_.xinit[Variables::POSITION+2] = PLANNING_HEIGHT;
+        // uavs far away if there are not enough
+        std::array<double, 2*Parameters::OTHER_UAVS> uavs;
+        uavs.fill(FAR_AWAY);
+        if constexpr(Parameters::MULTI){
+            int uav = 0;
+            for(auto it = problem.uavs_pose.begin(); it != problem.uavs_pose.end() && uav < Parameters::OTHER_UAVS; ++it){
+                if(it->first != problem.drone_id && it->second.has_pose){
+                    uavs[2*uav] = it->second.state.pose.x;
+                    uavs[2*uav+1] = it->second.state.pose.y;
+                    uav++;
+                }
+            }
+        }
+        pack(std::make_integer_sequence<int, HORIZON>(), initial_guess, problem, uavs);
+
+        evaluator_.begin();
+        const int exitflag = Model::solve(&params_, &output_, &info_, &Evaluator::evaluate);
+        evaluator_.end();
+        unpack(std::make_integer_sequence<int, HORIZON>(), initial_state.pose.z, solution);
+        return exitflag;
+    }
+
+    const typename Model::Info &info() const { return info_; }
+    const Evaluator &evaluator() const { return evaluator_; }
+
+private:
+    static void setVariables(Float *variables, const State &state){
+        variables[Variables::ACC] = state.acc.x;
+        variables[Variables::ACC+1] = state.acc.y;
+        variables[Variables::ACC+2] = state.acc.z;
+        variables[Variables::POSITION] = state.pose.x;
+        variables[Variables::POSITION+1] = state.pose.y;
+        variables[Variables::POSITION+2] = state.pose.z;
+        variables[Variables::VELOCITY] = state.velocity.x;
+        variables[Variables::VELOCITY+1] = state.velocity.y;
+        variables[Variables::VELOCITY+2] = state.velocity.z;
+    }
+
+    static constexpr double FAR_AWAY = 1e4;  /**< position of the missing uavs (m) */
+
+    template<int Stage>
+    void packStage(const State initial_guess[], const SolverProblem &problem, const std::array<double, 2*Parameters::OTHER_UAVS> &uavs){
+        setVariables(params_.x0 + Stage*Variables::SIZE, initial_guess[Stage]);
+        const nav_msgs::Odometry &desired_odometry = problem.desired_odometry;
+
+        Float *p = params_.all_parameters + Stage*Parameters::SIZE;
+        p[Parameters::DESIRED_POSITION] = desired_odometry.pose.pose.position.x;
+        p[Parameters::DESIRED_POSITION+1] = desired_odometry.pose.pose.position.y;
+        p[Parameters::DESIRED_POSITION+2] = PLANNING_HEIGHT;
+        p[Parameters::DESIRED_VELOCITY] = desired_odometry.twist.twist.linear.x;
+        p[Parameters::DESIRED_VELOCITY+1] = desired_odometry.twist.twist.linear.y;
+        p[Parameters::DESIRED_VELOCITY+2] = 0.0;
+        if constexpr(Parameters::TARGET){
+            const nav_msgs::Odometry &target = problem.target_trajectory[std::min<size_t>(Stage, problem.target_trajectory.size()-1)];
+            p[Parameters::TARGET_VELOCITY] = target.twist.twist.linear.x;
+            p[Parameters::TARGET_VELOCITY+1] = target.twist.twist.linear.y;
+            p[Parameters::TARGET_POSITION] = target.pose.pose.position.x;
+            p[Parameters::TARGET_POSITION+1] = target.pose.pose.position.y;
+        }
+        if constexpr(Parameters::MULTI){
+            std::copy(uavs.begin(), uavs.end(), p+Parameters::UAVS);
+        }
+        if constexpr(Parameters::NO_FLY_ZONE){
+            p[Parameters::OBSTACLE] = problem.no_fly_zone[0];
+            p[Parameters::OBSTACLE+1] = problem.no_fly_zone[1];
+        }
+    }
+
+    template<int... Stages>
+    void pack(std::integer_sequence<int, Stages...>, const State initial_guess[], const SolverProblem &problem,
+              const std::array<double, 2*Parameters::OTHER_UAVS> &uavs){
+        (packStage<Stages>(initial_guess, problem, uavs), ...);
+    }
+
+    template<int Stage>
+    void unpackStage(const double height, State solution[]) const{
+        const Float *x = reinterpret_cast<const Float*>(&output_) + Stage*Variables::SIZE;
+        State &state = solution[Stage];
+        state.acc.x = x[Variables::ACC];
+        state.acc.y = x[Variables::ACC+1];
+        state.acc.z = x[Variables::ACC+2];
+        state.pose.x = x[Variables::POSITION];
+        state.pose.y = x[Variables::POSITION+1];
+        state.pose.z = height;
+        state.velocity.x = x[Variables::VELOCITY];
+        state.velocity.y = x[Variables::VELOCITY+1];
+        state.velocity.z = x[Variables::VELOCITY+2];
+    }
+
+    template<int... Stages>
+    void unpack(std::integer_sequence<int, Stages...>, const double height, State solution[]) const{
+        (unpackStage<Stages>(height, solution), ...);
+    }
+
+    typename Model::Params params_;
+    typename Model::Output output_;
+    typename Model::Info info_;
+    Evaluator evaluator_;
+};
+
+}
+
+#endif
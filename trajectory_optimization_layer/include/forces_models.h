@@ -0,0 +1,25 @@
+#ifndef FORCES_MODELS_H
+#define FORCES_MODELS_H
+
+#include <forces_front_end.h>
+
+/** Generated FORCES solvers of the backend, one per horizon. setup_solver_target_model.m names them FORCESNLPsolver_<model.N>, and they
+ *  are built by CMakeLists.txt (FORCES_MODELS) if their library is in solver/. CMakeLists.txt defines FORCES_HAS_<name> for every solver
+ *  it builds, and only those are included.
+ *  FORCESNLPsolver is the 40 step solver generated before the solvers had the horizon in their name. It is only used if
+ *  FORCESNLPsolver_40 has not been generated
+ */
+#ifdef FORCES_HAS_FORCESNLPsolver_40
+#include <FORCESNLPsolver_40.h>
+FORCES_GENERATED_MODEL(FORCESNLPsolver_40, 40, FORCES_TARGET)
+#elif defined(FORCES_HAS_FORCESNLPsolver)
+#include <FORCESNLPsolver.h>
+FORCES_GENERATED_MODEL(FORCESNLPsolver, 40, FORCES_TARGET)
+#endif
+
+#ifdef FORCES_HAS_FORCESNLPsolver_100
+#include <FORCESNLPsolver_100.h>
+FORCES_GENERATED_MODEL(FORCESNLPsolver_100, 100, FORCES_TARGET | FORCES_MULTI)
+#endif
+
+#endif
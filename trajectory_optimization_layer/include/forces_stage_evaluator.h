@@ -0,0 +1,257 @@
+#ifndef FORCES_STAGE_EVALUATOR_H
+#define FORCES_STAGE_EVALUATOR_H
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NumericalSolver{
+
+/** Threads that run a function over the stages of a horizon, split in contiguous chunks. The calling thread runs the first chunk and
+ *  waits for the rest. The function is a plain pointer with its context, so a run does not allocate
+ */
+class StagePool{
+
+public:
+    typedef void (*Function)(void *context, const int begin, const int end);
+
+    /** \param threads threads besides the calling one. 0: the stages are run in the calling thread
+     *  \param min_chunk stages of the smallest chunk, below it a thread costs more than it saves
+     */
+    StagePool(const int threads, const int min_chunk);
+    ~StagePool();
+    StagePool(const StagePool &) = delete;
+    StagePool &operator=(const StagePool &) = delete;
+
+    void run(const int stages, Function function, void *context);
+    int threads() const { return workers_.size(); }
+
+private:
+    void worker(const int thread);
+
+    std::vector<std::thread> workers_;
+    const int min_chunk_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    Function function_ = nullptr;
+    void *context_ = nullptr;
+    int chunks_ = 0;            /**< chunks of the current run, the first one is the calling thread's */
+    int chunk_size_ = 0;
+    int stages_ = 0;
+    int pending_ = 0;           /**< chunks of the workers not finished */
+    unsigned run_ = 0;          /**< runs started, the workers wait for a new one */
+    bool stop_ = false;
+};
+
+/** Parallel evaluation of the external functions of a generated model (its casadi2forces) across the stages.
+ *  FORCES calls the callback stage by stage, and in a solve it keeps the variables and the parameters of every stage in the same place. The
+ *  first sweep of a solve is evaluated as it comes and its pointers are kept. From then on, the call of the first stage evaluates all the
+ *  stages of the kept pointers at once in the StagePool, with the outputs asked for the first stage, into buffers of the evaluator. Every
+ *  call of a stage takes its result if it has the same pointers, asks for outputs that were evaluated, and its variables and parameters
+ *  did not change after the evaluation. Otherwise the stage is evaluated as it comes, so the result is always the one of the serial
+ *  evaluation. The pointers of a sweep are kept for the variables of its first stage, as the line search evaluates the trial point in
+ *  another buffer.
+ *  The outputs are copied entry by entry except the ones the model did not write (sentinel), as casadi2forces leaves the structural zeros.
+ *  The generated models only read the variables and the parameters (n_in = 2), and do not fill the hessian: the sweeps that ask for it
+ *  are not evaluated ahead.
+ *  It works between begin() and end(), the callback of Model::solve is a plain function without context. Without threads in the pool the
+ *  stages are evaluated as they come.
+ *  Across the stages the generated code is scalar and branches on the inputs, so it is not vectorized: each chunk runs its stages one
+ *  after another
+ */
+template<class Model, class Layout>
+class ForcesStageEvaluator{
+
+public:
+    typedef typename Model::Float Float;
+    static constexpr int HORIZON = Model::HORIZON;
+
+    ForcesStageEvaluator(StagePool &pool) : pool_(pool){}
+
+    /** \brief evaluate the stages with this evaluator until end() */
+    void begin(){
+        for(Sweep &sweep : sweeps_){
+            for(StageCall &call : sweep.calls){
+                call.x = nullptr;
+                call.ready = false;
+            }
+            sweep.last_use = 0;
+        }
+        uses_ = 0;
+        sweep_ = &sweeps_[0];
+        active_ = this;
+    }
+    void end(){ active_ = nullptr; }
+
+    /** \brief callback of Model::solve, with the signature of casadi2forces */
+    static void evaluate(Float *x, Float *y, Float *l, Float *p, Float *f, Float *nabla_f, Float *c, Float *nabla_c, Float *h,
+                         Float *nabla_h, Float *hess, int stage, int iteration){
+        ForcesStageEvaluator *evaluator = active_;
+        if(!evaluator || evaluator->pool_.threads() == 0 || stage < 0 || stage >= HORIZON){
+            Model::evaluate(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, hess, stage, iteration);
+            return;
+        }
+        const unsigned outputs = outputMask(f, nabla_f, c, nabla_c, h, nabla_h, hess);
+        if(stage == 0){
+            evaluator->sweep_ = evaluator->sweepOf(x);
+            if(!(outputs & HESSIAN) && evaluator->sweep_->recorded()){
+                evaluator->iteration_ = iteration;
+                evaluator->outputs_ = outputs;
+                evaluator->pool_.run(HORIZON, &ForcesStageEvaluator::evaluateChunk, evaluator);
+                evaluator->ahead_sweeps_++;
+            }
+        }
+        StageCall &call = evaluator->sweep_->calls[stage];
+        if(call.ready && call.x == x && call.p == p && !(outputs & ~call.evaluated) && unchanged(call, x, p)){
+            call.deliver(f, nabla_f, c, nabla_c, h, nabla_h);
+        }
+        else{
+            Model::evaluate(x, y, l, p, f, nabla_f, c, nabla_c, h, nabla_h, hess, stage, iteration);
+            evaluator->serial_stages_++;
+        }
+        call.ready = false;
+        call.x = x;
+        call.y = y;
+        call.l = l;
+        call.p = p;
+    }
+
+    int ahead_sweeps_ = 0;   /**< sweeps evaluated in the pool */
+    int serial_stages_ = 0;  /**< stages evaluated as they were called */
+
+private:
+    enum Output : unsigned{ OBJECTIVE = 1u, GRADIENT = 2u, DYNAMICS = 4u, DYNAMICS_JACOBIAN = 8u, INEQUALITIES = 16u, INEQUALITIES_JACOBIAN = 32u, HESSIAN = 64u };
+    static constexpr int NVAR = Layout::NVAR;
+    static constexpr int NPAR = Layout::NPAR;
+    static constexpr int NEQ = Layout::NEQ;
+    static constexpr int NH = Layout::NH;
+
+    /** outputs of a stage, and the pointers of its last call */
+    struct StageCall{
+        Float *x = nullptr, *y = nullptr, *l = nullptr, *p = nullptr;
+        unsigned evaluated = 0;             /**< outputs of the evaluation ahead */
+        bool ready = false;                 /**< evaluated ahead and not delivered */
+        std::array<Float, NVAR> x_used;     /**< variables and parameters of the evaluation ahead */
+        std::array<Float, NPAR> p_used;
+        Float f;
+        std::array<Float, NVAR> nabla_f;
+        std::array<Float, NEQ> c;
+        std::array<Float, NEQ*NVAR> nabla_c;
+        std::array<Float, NH> h;
+        std::array<Float, NH*NVAR> nabla_h;
+
+        template<size_t N>
+        static void copy(const std::array<Float, N> &from, Float *to){
+            for(size_t i=0; i<N; i++){
+                if(!isSentinel(from[i])){
+                    to[i] = from[i];
+                }
+            }
+        }
+        void deliver(Float *f_out, Float *nabla_f_out, Float *c_out, Float *nabla_c_out, Float *h_out, Float *nabla_h_out) const{
+            if(f_out) *f_out += f;
+            if(nabla_f_out) copy(nabla_f, nabla_f_out);
+            if(c_out) copy(c, c_out);
+            if(nabla_c_out) copy(nabla_c, nabla_c_out);
+            if(h_out) copy(h, h_out);
+            if(nabla_h_out) copy(nabla_h, nabla_h_out);
+        }
+    };
+
+    static unsigned outputMask(const Float *f, const Float *nabla_f, const Float *c, const Float *nabla_c, const Float *h, const Float *nabla_h, const Float *hess){
+        return (f ? OBJECTIVE : 0u) | (nabla_f ? GRADIENT : 0u) | (c ? DYNAMICS : 0u) | (nabla_c ? DYNAMICS_JACOBIAN : 0u) | (h ? INEQUALITIES : 0u) |
+               (nabla_h ? INEQUALITIES_JACOBIAN : 0u) | (hess ? HESSIAN : 0u);
+    }
+
+    /** a signaling NaN with a payload the model can't compute, the entries it keeps are the ones it did not write */
+    static Float sentinel(){
+        static_assert(sizeof(Float) == sizeof(uint64_t), "the sentinel is a double");
+        const uint64_t bits = 0x7ff4dead0000beefull;
+        Float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    static bool isSentinel(const Float value){
+        const Float marker = sentinel();
+        return std::memcmp(&value, &marker, sizeof(value)) == 0;
+    }
+
+    /** pointers of the stages of a sweep, found by the variables of its first stage */
+    struct Sweep{
+        std::array<StageCall, HORIZON> calls;
+        unsigned last_use = 0;
+
+        /** \brief all the stages were called once in this solve */
+        bool recorded() const{
+            return std::all_of(calls.begin(), calls.end(), [](const StageCall &call){ return call.x != nullptr; });
+        }
+    };
+
+    static bool unchanged(const StageCall &call, const Float *x, const Float *p){
+        return std::memcmp(call.x_used.data(), x, sizeof(call.x_used)) == 0 && std::memcmp(call.p_used.data(), p, sizeof(call.p_used)) == 0;
+    }
+
+    /** \brief sweep with these variables in its first stage, or the least recently used one */
+    Sweep *sweepOf(const Float *x){
+        Sweep *sweep = &sweeps_[0];
+        for(Sweep &candidate : sweeps_){
+            if(candidate.calls[0].x == x){
+                sweep = &candidate;
+                break;
+            }
+            if(candidate.last_use < sweep->last_use){
+                sweep = &candidate;
+            }
+        }
+        if(sweep->calls[0].x != x){
+            for(StageCall &call : sweep->calls){
+                call.x = nullptr;
+                call.ready = false;
+            }
+        }
+        sweep->last_use = ++uses_;
+        return sweep;
+    }
+
+    static void evaluateChunk(void *context, const int begin, const int end){
+        ForcesStageEvaluator *evaluator = static_cast<ForcesStageEvaluator*>(context);
+        for(int stage=begin; stage<end; stage++){
+            StageCall &call = evaluator->sweep_->calls[stage];
+            std::copy(call.x, call.x+NVAR, call.x_used.begin());
+            std::copy(call.p, call.p+NPAR, call.p_used.begin());
+            call.f = 0.0;
+            call.nabla_f.fill(sentinel());
+            call.c.fill(sentinel());
+            call.nabla_c.fill(sentinel());
+            call.h.fill(sentinel());
+            call.nabla_h.fill(sentinel());
+            const unsigned outputs = evaluator->outputs_;
+            Model::evaluate(call.x_used.data(), call.y, call.l, call.p_used.data(), outputs & OBJECTIVE ? &call.f : nullptr,
+                            outputs & GRADIENT ? call.nabla_f.data() : nullptr, outputs & DYNAMICS ? call.c.data() : nullptr,
+                            outputs & DYNAMICS_JACOBIAN ? call.nabla_c.data() : nullptr, outputs & INEQUALITIES ? call.h.data() : nullptr,
+                            outputs & INEQUALITIES_JACOBIAN ? call.nabla_h.data() : nullptr, nullptr, stage, evaluator->iteration_);
+            call.evaluated = outputs;
+            call.ready = true;
+        }
+    }
+
+    static const int SWEEPS = 2;  /**< buffers of the variables: the iterate and the trial point of the line search */
+
+    StagePool &pool_;
+    std::array<Sweep, SWEEPS> sweeps_;
+    Sweep *sweep_ = nullptr;      /**< sweep of the last call */
+    unsigned uses_ = 0;
+    int iteration_ = 0;
+    unsigned outputs_ = 0;  /**< outputs of the first stage, evaluated for all the stages */
+    static inline ForcesStageEvaluator *active_ = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef PROBLEM_RECORDER_H
+#define PROBLEM_RECORDER_H
+
+#include <ros/ros.h>
+#include <solver.h>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace SolverUtils{
+
+/**
+ * Binary capture of the planning steps. Every record has the whole input of the solver (previous solution, initial guess, uavs states,
+ * target trajectory, shot and options) and its output, so the step can be solved again offline with replay_solver.
+ * The control thread fills preallocated records of a single producer single consumer queue, without locks, and a writer thread saves
+ * them. If the writer falls behind, the records that don't fit in the queue are dropped and counted.
+ */
+class ProblemRecorder{
+
+public:
+    /** Input and output of one planning step. Odometries are saved as states (position, orientation and linear velocity)
+     */
+    struct Record{
+        uint32_t step = 0;                  /**< planning step since the recorder was opened */
+        double time = 0.0;                  /**< time of the initial state (s) */
+        float initial_time = 0.0;           /**< time of the initial state from the first point of the previous solution (s) */
+        int32_t drone_id = 1;
+        int32_t shot_type = 0;
+        uint8_t first_time_solving = true;
+        uint8_t target = true;
+        uint8_t multi = false;
+        NumericalSolver::SolverOptions options;
+        State desired;
+        std::vector<float> no_fly_zone;
+        std::vector<State> previous_solution;
+        std::vector<State> initial_guess;
+        std::vector<State> target_trajectory;
+        std::vector<State> reference_trajectory;
+        std::vector<std::pair<int32_t,State>> uavs;
+        // output
+        int32_t status = -1;
+        double solving_time = 0.0;
+        std::vector<State> solution;
+    };
+
+    /** \param time_horizon number of states of a solution
+     *  \param capacity records in the queue
+     */
+    ProblemRecorder(const int time_horizon, const size_t capacity = 64);
+    ~ProblemRecorder();
+
+    /** \brief create the capture file and start the writer thread
+     *  \return false if the file can't be created
+     */
+    bool open(const std::string &path);
+    /** \brief next record to fill. Only the control thread can call it
+     *  \return nullptr if the queue is full, the step is not captured
+     */
+    Record *begin();
+    /** \brief queue the record given by begin() */
+    void commit();
+    size_t dropped() const { return dropped_; }
+
+    /** \brief read the header of a capture file
+     *  \return false if it is not a capture file of this version
+     */
+    static bool readHeader(std::istream &input, int &time_horizon);
+    /** \brief read the next record of a capture file
+     *  \return false at the end of the file
+     */
+    static bool read(std::istream &input, Record &record);
+
+    static State toState(const nav_msgs::Odometry &odometry);
+    static nav_msgs::Odometry toOdometry(const State &state);
+
+private:
+    void write(const Record &record);
+    /** \brief loop of the writer thread */
+    void writer();
+
+    const int time_horizon_;
+    std::vector<Record> queue_;
+    std::atomic<size_t> head_{0};       /**< next record to fill, written by the control thread */
+    std::atomic<size_t> tail_{0};       /**< next record to save, written by the writer thread */
+    std::atomic<bool> running_{false};
+    size_t dropped_ = 0;
+    uint32_t steps_ = 0;
+    std::ofstream file_;
+    std::thread writer_;
+    static const int FILE_VERSION = 3;
+    static const int MAGIC = 0x50434f4f;  /**< "OOCP" */
+};
+
+}
+
+#endif
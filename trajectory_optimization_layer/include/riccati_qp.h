@@ -0,0 +1,101 @@
+#ifndef RICCATI_QP_H
+#define RICCATI_QP_H
+
+#include <Eigen/Eigen>
+#include <vector>
+#include <algorithm>
+
+namespace NumericalSolver{
+
+/** Sparse QP of an optimal control problem, solved with ADMM. The variables of every stage are its state and its input, w_k = [x_k | u_k]:
+ *      min sum 1/2 w_k'P_k w_k + q_k'w_k   subject to   x_k+1 = A x_k + B u_k,   l_k <= G w_k <= u_k,   x_0 given
+ * The linear system of an ADMM iteration is the same optimal control problem without inequalities, so it is solved with a Riccati
+ * recursion instead of factorizing the whole KKT matrix: the cost of an iteration is linear in the number of stages.
+ * The gains of the recursion only depend on the hessians and on the penalty, so they are computed in factorize(), and every iteration
+ * only runs the backward pass of the linear terms and the forward rollout.
+ * The constraints of the given state x_0 are not enforced: their bounds must be infinite, or the problem is infeasible.
+ */
+class RiccatiQP{
+
+public:
+    static const int NX = 6;        /**< states of a stage */
+    static const int NU = 4;        /**< inputs of a stage */
+    static const int NW = NX+NU;    /**< variables of a stage */
+    static const int NC = 8;        /**< constraints of a stage */
+    typedef Eigen::Matrix<double, NX, 1> StateVector;
+    typedef Eigen::Matrix<double, NW, 1> StageVector;
+    typedef Eigen::Matrix<double, NW, NW> StageMatrix;
+    typedef Eigen::Matrix<double, NC, 1> ConstraintVector;
+    typedef Eigen::Matrix<double, NX, NX> StateMatrix;
+    typedef Eigen::Matrix<double, NX, NU> InputMatrix;
+    typedef Eigen::Matrix<double, NC, NW> ConstraintMatrix;
+
+    struct Stage{
+        StageMatrix P = StageMatrix::Zero();        /**< hessian (positive semidefinite) */
+        StageVector q = StageVector::Zero();        /**< linear cost */
+        ConstraintVector lower = ConstraintVector::Zero();
+        ConstraintVector upper = ConstraintVector::Zero();
+        StageVector w = StageVector::Zero();        /**< solution. Its value is the warm start */
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    /** \param stages number of stages, the input of the last one only changes the cost
+     *  \param A, B dynamics
+     *  \param G constraint matrix of every stage
+     *  \param rho initial ADMM penalty
+     *  \param sigma regularization of the hessians
+     */
+    RiccatiQP(const int stages, const StateMatrix &A, const InputMatrix &B, const ConstraintMatrix &G, const double rho = 1.0, const double sigma = 1e-6);
+
+    /** \brief compute the gains of the Riccati recursion. Call it after changing the hessians
+     */
+    void factorize();
+    /** \brief solve the QP with the linear costs and bounds of the stages
+     *  \param x0 state of the first stage
+     *  \return number of iterations, -1 if it did not converge
+     */
+    int solve(const StateVector &x0);
+
+    /** \brief solve only the first stages, without reallocating. Call factorize() after changing them
+     *  \param stages number of stages, at most the ones of the constructor
+     */
+    void setStages(const int stages) { active_stages_ = std::min<int>(std::max(stages, 1), stages_.size()); }
+
+    Stage &stage(const int k) { return stages_[k]; }
+    const Stage &stage(const int k) const { return stages_[k]; }
+    int stages() const { return active_stages_; }
+
+    int max_iterations_ = 4000;
+    double tolerance_ = 1e-6; /**< primal and dual residual to stop (inf norm) */
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+    /** gains of the Riccati recursion and ADMM variables of a stage */
+    struct Workspace{
+        Eigen::LLT<Eigen::Matrix<double, NU, NU>> quu;
+        Eigen::Matrix<double, NU, NX> qux;
+        Eigen::Matrix<double, NU, NX> K;             /**< feedback gain */
+        Eigen::Matrix<double, NU, 1> k;              /**< feedforward of the last iteration */
+        StateMatrix S;                               /**< hessian of the cost to go */
+        StateVector s;                               /**< gradient of the cost to go */
+        ConstraintVector z;                          /**< Gw projected on the bounds */
+        ConstraintVector y;                          /**< multipliers */
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    const StateMatrix A_;
+    const InputMatrix B_;
+    const ConstraintMatrix G_;
+    const StageMatrix GtG_;
+    double rho_;                      /**< ADMM penalty. It is adapted to balance primal and dual residuals */
+    const double sigma_;
+    static const int RHO_UPDATE_ITERATIONS = 25;
+    static const int CHECK_ITERATIONS = 5;  /**< iterations between the checks of the residuals. RHO_UPDATE_ITERATIONS must be a multiple */
+    std::vector<Stage, Eigen::aligned_allocator<Stage>> stages_;
+    std::vector<Workspace, Eigen::aligned_allocator<Workspace>> workspace_;
+    int active_stages_;               /**< stages that are solved */
+};
+
+}
+
+#endif
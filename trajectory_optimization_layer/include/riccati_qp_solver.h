@@ -0,0 +1,53 @@
+#ifndef RICCATI_QP_SOLVER_H
+#define RICCATI_QP_SOLVER_H
+
+#include <solver.h>
+#include <solver_backend.h>
+#include <riccati_qp.h>
+#include <memory>
+
+namespace NumericalSolver{
+
+/** Same problem as the condensed QP solver, without condensing it: the states are kept as variables and the QP is solved stage by stage
+ * with a Riccati recursion (RiccatiQP), so the cost of an iteration grows linearly with the horizon instead of cubically. It is meant for
+ * long horizons, where the dense QP does not fit in the solving rate.
+ * The stages are the steps 1..N-1, the state of the step 1 is fixed by the initial state and its acceleration. The variables of a stage are
+ *      [position (3) | velocity (3) | acceleration (3) | slack of the height constraint (1)]
+ * The initial velocity is the one of the initial state also the first time. The camera pitch term is linearized (Gauss-Newton) around the
+ * last trajectory, as in the condensed QP solver (SQP).
+ * The horizon of the options is solved and the rest of the horizon brakes, as in the ACADO solver. The time grid is not used.
+ */
+class RiccatiQPSolver : public Solver{
+
+public:
+    static const int QP_NOT_CONVERGED = -1;
+
+    RiccatiQPSolver(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess);
+
+    int solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position = 0, bool first_time_solving = true, const int _drone_id = 1, const bool _target = true, const bool _multi = false);
+
+    static constexpr double QP_TOLERANCE = 1e-3;  /**< nominal tolerance of the ADMM residuals */
+    int max_sqp_iterations_ = 5;
+    double sqp_tolerance_ = 1e-2;  /**< max change of the positions to stop the SQP (m) */
+    int qp_iterations_ = 0;        /**< ADMM iterations of the last solve, all the SQP iterations */
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+    enum Variable{ PX, PY, PZ, VX, VY, VZ, AX, AY, AZ, SLACK };
+    enum Constraint{ ACC_X, ACC_Y, ACC_Z, VEL_X, VEL_Y, VEL_Z, HEIGHT, POSITIVE_SLACK };
+
+    std::unique_ptr<RiccatiQP> qp_;
+    RiccatiQP::StageMatrix hessian_fixed_;      /**< accelerations and slack */
+    Eigen::MatrixXd trajectory_;                /**< positions to linearize the pitch term, one row per step */
+    // buffers of a solve, sized for the horizon so the solves don't allocate
+    Eigen::MatrixXd target_;                    /**< target position, one row per step */
+    std::vector<RiccatiQP::StageMatrix, Eigen::aligned_allocator<RiccatiQP::StageMatrix>> hessian_;  /**< cost without the pitch term */
+    std::vector<RiccatiQP::StageVector, Eigen::aligned_allocator<RiccatiQP::StageVector>> q_;
+    std::vector<State> grid_solution_;
+};
+
+typedef SolverPlugin<RiccatiQPSolver> RiccatiQPBackend;
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <backendSolver.h>
+#include <shot_executer.h>
+#include <follower_control_law.h>
+#include <Eigen/Eigen>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** Closed-loop simulator to test the planner without ROS master, UAL or MRS.
+ * In every scenario the following loop is run with a fake clock, so it runs faster than real time:
+ *      scripted target model -> ShotExecuter::calculateDesiredPoint -> backendSolver::planningStep -> follower control law -> point-mass UAV
+ * Tracking error, solve times and solver failures are measured for each scenario.
+ **/
+namespace Simulation{
+
+/** Fake clock. Time only advances when the simulator says so
+ */
+class SimClock{
+public:
+    double now() const { return time_; }
+    void advance(const double dt) { time_ += dt; }
+private:
+    double time_ = 0.0;
+};
+
+/** Point-mass UAV. The commanded velocity is tracked with a first order response, saturated in acceleration
+ */
+class PointMassUav{
+public:
+    PointMassUav(const Eigen::Vector3d &position, const double max_acc = 1.0, const double time_constant = 0.3);
+    /** \brief integrate the dynamics
+     *  \param velocity_command commanded velocity
+     *  \param dt integration step (s)
+     */
+    void step(const Eigen::Vector3d &velocity_command, const double dt);
+    const Eigen::Vector3d &position() const { return position_; }
+    const Eigen::Vector3d &velocity() const { return velocity_; }
+private:
+    Eigen::Vector3d position_;
+    Eigen::Vector3d velocity_ = Eigen::Vector3d::Zero();
+    const double max_acc_;
+    const double time_constant_;
+};
+
+/** Scripted target model
+ */
+class TargetModel{
+public:
+    virtual ~TargetModel() {}
+    /** \brief target odometry at time t
+     */
+    virtual nav_msgs::Odometry odometry(const double t) const = 0;
+};
+
+/** Target moving with constant velocity
+ */
+class ConstantVelocityTarget : public TargetModel{
+public:
+    ConstantVelocityTarget(const Eigen::Vector3d &position, const Eigen::Vector3d &velocity) : position_(position), velocity_(velocity) {}
+    nav_msgs::Odometry odometry(const double t) const;
+private:
+    const Eigen::Vector3d position_;
+    const Eigen::Vector3d velocity_;
+};
+
+/** Target moving along a horizontal circle
+ */
+class CircleTarget : public TargetModel{
+public:
+    CircleTarget(const Eigen::Vector3d &center, const double radius, const double speed) : center_(center), radius_(radius), speed_(speed) {}
+    nav_msgs::Odometry odometry(const double t) const;
+private:
+    const Eigen::Vector3d center_;
+    const double radius_;
+    const double speed_;
+};
+
+/** Target that alternates between moving with constant velocity and stopping
+ */
+class StopAndGoTarget : public TargetModel{
+public:
+    StopAndGoTarget(const Eigen::Vector3d &position, const Eigen::Vector3d &velocity, const double go_time, const double stop_time)
+        : position_(position), velocity_(velocity), go_time_(go_time), stop_time_(stop_time) {}
+    nav_msgs::Odometry odometry(const double t) const;
+private:
+    const Eigen::Vector3d position_;
+    const Eigen::Vector3d velocity_;
+    const double go_time_;
+    const double stop_time_;
+};
+
+/** Shot scenario to simulate
+ */
+struct Scenario{
+    std::string name;
+    ShotExecuter::shooting_action action;
+    Eigen::Vector3d uav_initial_position = Eigen::Vector3d::Zero();
+    std::shared_ptr<TargetModel> target;
+    double duration = 30.0; /**< simulated time (s) */
+};
+
+/** Metrics of a simulated scenario
+ */
+struct ScenarioResult{
+    std::string name;
+    bool success = false;
+    int solver_calls = 0;
+    int solver_failures = 0;
+    std::vector<double> solve_times; /**< wall time of each planning step (s) */
+    double mean_tracking_error = 0.0; /**< mean distance to the shot pose over the second half of the scenario (m) */
+    double final_tracking_error = 0.0; /**< distance to the shot pose at the end of the scenario (m) */
+};
+
+/** backendSolver without ROS communication. The simulator writes the state directly and calls the planning step
+ */
+class PlannerHarness : public backendSolver{
+public:
+    PlannerHarness(const int time_horizon, const float solver_rate, const int drone_id = 1);
+    void setUavState(const Eigen::Vector3d &position, const Eigen::Vector3d &velocity);
+    void setTarget(const nav_msgs::Odometry &target_odometry);
+    void setDesiredShot(const shot_executer::DesiredShot &desired_shot);
+    /** \brief set the no fly zone
+     *  \param center [x y] or empty to remove it
+     */
+    void setNoFlyZone(const std::vector<float> &center);
+    /** \brief call backendSolver::planningStep as stateMachine does every cycle
+     *  \param time simulated time of the cycle (s). The harness has no latency, the new plan starts there
+     *  \return solver status
+     */
+    int plan(const double time);
+    /** \brief replace the solver backend, ACADO by default
+     */
+    void setBackend(const boost::shared_ptr<NumericalSolver::SolverBackend> &backend);
+    /** \brief warm up the solver as the node does at startup
+     *  \return heap allocations of the last warm-up solve
+     */
+    uint64_t warmUp() { return backendSolver::warmUp(); }
+    /** \brief check a solver status as stateMachine does
+     */
+    static bool solverSucceeded(const int status);
+    /** \brief last solved trajectory in the format received by the follower
+     */
+    void getTrajectory(std::vector<geometry_msgs::PoseStamped> &positions, std::vector<geometry_msgs::Twist> &velocities) const;
+    /** \brief last solved trajectory with accelerations
+     */
+    std::vector<State> getSolution() const;
+    /** \brief simulated time of the first point of the last solved trajectory (s)
+     */
+    double getSolutionStart() const { return plan_start_; }
+};
+
+/** Closed-loop simulator
+ */
+class ClosedLoopSimulator{
+public:
+    ClosedLoopSimulator(const int time_horizon = 40, const float solver_rate = 1.0);
+    /** \brief simulate a scenario
+     *  \param scenario shot, target model and initial pose
+     *  \return metrics of the scenario
+     */
+    ScenarioResult run(const Scenario &scenario);
+
+    double success_tolerance_ = 3.0; /**< final tracking error (m) to consider a scenario successful */
+private:
+    const int time_horizon_;
+    const float solver_rate_;        /**< planner rate (Hz) */
+    const float step_size_ = 0.2;    /**< step size of the target prediction (s) */
+    const double control_rate_ = 10; /**< follower rate (Hz). It is also the simulation step */
+    const double shot_rate_ = 5;     /**< shot executer rate (Hz) */
+    const double look_ahead_ = 1.0;  /**< look ahead of the follower (m) */
+    const float MIN_XY_VEL = 0.4;    /**< the target yaw is updated only above this velocity, as in the shot executer */
+};
+
+}
+
+#endif
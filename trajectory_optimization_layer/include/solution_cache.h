@@ -0,0 +1,100 @@
+#ifndef SOLUTION_CACHE_H
+#define SOLUTION_CACHE_H
+
+#include <ros/ros.h>
+#include <UAVState.h>
+#include <array>
+#include <fstream>
+#include <list>
+#include <string>
+#include <limits>
+#include <vector>
+
+namespace SolverUtils{
+
+/**
+ * Cache of solved trajectories for repeated shots. In rehearsed shots the same problem is solved from nearly the same state every take.
+ * The problem is described by a feature vector: initial state, desired pose, shot type, target state, no fly zone, other uavs and shot
+ * reference. The discrete features (shot type, first solve, target, multi, reference points) must be equal, the continuous ones are
+ * compared with tolerances. A lookup takes the nearest cached problem and gives:
+ *      HIT         it is within the tolerances, the cached trajectory is the answer
+ *      WARM_START  it is within the warm start radius (the resolutions), the cached trajectory is used as initial guess
+ *      MISS
+ * The lookup is a scan of the entries: there are a few hundred and it is much cheaper than a solve, and a problem near the edge of a
+ * quantization cell still finds its neighbours. Least recently used entries are evicted. If a file is loaded, every new entry is
+ * appended to it, so the cache survives restarts of the node.
+ * The cached trajectories start at the initial state of their problem: the owner splices them with its current plan.
+ */
+class SolutionCache{
+
+public:
+    /** indexes of the feature vector */
+    enum Feature{ X, Y, Z, VX, VY, VZ, DESIRED_X, DESIRED_Y, DESIRED_Z, SHOT_TYPE, TARGET_X, TARGET_Y, TARGET_Z, TARGET_VX, TARGET_VY, TARGET_VZ,
+                  FIRST_TIME, TARGET, MULTI, NO_FLY_ZONE_X, NO_FLY_ZONE_Y, UAV_1_X, UAV_1_Y, UAV_1_Z, UAV_2_X, UAV_2_Y, UAV_2_Z,
+                  REFERENCE_X, REFERENCE_Y, REFERENCE_Z, REFERENCE_POINTS, N_FEATURES };
+    typedef std::array<double, N_FEATURES> Features;
+    static const int OTHER_UAVS = 2;             /**< other uavs in the features, the missing ones are far away */
+    static constexpr double FAR_AWAY = 1e4;      /**< position of the missing uavs and no fly zone (m) */
+
+    enum LookupResult{ MISS, WARM_START, HIT };
+
+    /** \param time_horizon number of states of a solution
+     *  \param capacity maximum number of entries
+     */
+    SolutionCache(const int time_horizon, const size_t capacity = 256);
+
+    /** \brief load the entries of a persistence file and keep appending the new ones to it. The file is created if it does not exist
+     *  \param path persistence file
+     *  \return false if the file can't be opened
+     */
+    bool load(const std::string &path);
+    /** \brief search the nearest problem in the cache
+     *  \param features problem to solve
+     *  \param solution cached trajectory if the result is not MISS, from the initial state of the cached problem
+     *  \return MISS, WARM_START or HIT
+     */
+    LookupResult lookup(const Features &features, State solution[]);
+    /** \brief save a solved problem. It replaces a cached problem within the tolerances
+     *  \param features solved problem
+     *  \param solution solved trajectory from the initial state (time_horizon states). Only converged solutions must be saved
+     */
+    void insert(const Features &features, const State solution[]);
+    size_t size() const { return entries_.size(); }
+
+    double position_resolution_ = 0.5;       /**< max position difference (m) to take a cached trajectory as initial guess */
+    double velocity_resolution_ = 0.25;      /**< max velocity difference (m/s) to take a cached trajectory as initial guess */
+    double position_tolerance_  = 0.05;      /**< max position difference (m) to take a cached trajectory as the answer */
+    double velocity_tolerance_  = 0.05;      /**< max velocity difference (m/s) to take a cached trajectory as the answer */
+
+private:
+    struct Entry{
+        Features features;
+        std::vector<State> solution;
+    };
+
+    bool isPosition(const int feature) const;
+    bool isVelocity(const int feature) const;
+    /** \brief largest difference of the continuous features, relative to the warm start radius. Infinite if a discrete feature differs
+     */
+    double distance(const Features &a, const Features &b) const;
+    bool withinTolerances(const Features &a, const Features &b) const;
+    /** \brief nearest entry within the warm start radius, or end() */
+    std::list<Entry>::iterator nearest(const Features &features);
+    /** \brief put an entry as the most recently used one and evict the least recently used if the cache is full */
+    void store(const Features &features, const State solution[]);
+    void writeEntry(const Entry &entry);
+    /** \brief write the persistence file again with the entries in the cache, oldest first */
+    bool rewrite();
+
+    const int time_horizon_;
+    const size_t capacity_;
+    std::list<Entry> entries_;   /**< most recently used first */
+    std::string path_;
+    std::ofstream file_;         /**< persistence file, open only if load() has been called */
+    size_t file_entries_ = 0;    /**< entries written in the file, evicted ones included */
+    static const int FILE_VERSION = 2;
+};
+
+}
+
+#endif
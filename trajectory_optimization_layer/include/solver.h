@@ -10,11 +10,23 @@
 #include <acado/utils/acado_utils.hpp>
 #include <nav_msgs/Odometry.h>
 #include <memory>
+#include <Eigen/Eigen>
 #include <UAVState.h>
 USING_NAMESPACE_ACADO
 
 namespace NumericalSolver{
 
+/** Options of a solve. The fallback ladder of backendSolver relaxes them when the nominal problem can't be solved
+ */
+struct SolverOptions{
+    double tolerance_scale = 1.0;  /**< factor of the nominal tolerances of the solver */
+    double max_time = 1.0;         /**< time budget of the solve (s) */
+    int horizon = 0;               /**< steps that are optimized, the rest of the horizon brakes. 0: the whole horizon */
+    std::vector<double> time_grid; /**< times of the nodes of the problem from the initial state (s), see Solver::timeGrid. Empty: one node
+                                        every step. The solution is always given every step */
+    bool discrete_dynamics = false; /**< exact discrete-time model instead of integrating the continuous one. Only with a uniform grid */
+};
+
 class Solver{
 
 private:
@@ -37,6 +49,9 @@ protected:
     const float MAX_VEL_Z = 0.5;
     const float W_PX_N = 0.1;
     const float W_PY_N = 0.1;
+    const float W_PX = 0.05;  /*! weights to track the shot reference along the horizon */
+    const float W_PY = 0.05;
+    const float W_PZ = 0.05;
     const float W_AX = 1;
     const float W_AY = 1;
     const float W_AZ = 1;
@@ -44,6 +59,24 @@ protected:
     
     std::shared_ptr<State[]> initial_guess_;
     const int time_horizon_;
+    SolverOptions options_;
+    std::vector<State> followed_;  /**< buffer of setSolution, so a solve does not allocate */
+
+    /** \brief steps optimized with the current options */
+    int solvedHorizon() const { return options_.horizon > 0 && options_.horizon < time_horizon_ ? options_.horizon : time_horizon_; }
+    /** \brief times of the nodes of the current problem, from 0 to the end of the solved horizon. One node every step without time grid
+     */
+    std::vector<double> solvedGrid() const;
+
+    /** \brief save the solution of the solver. If it is not the first time, the first offset_ points are the previous solution interpolated
+     *         in the offset_ steps before the initial state, because it is followed while solving
+     *  \param grid_solution solution on the solver grid, starting at initialState()
+     *  \param time_initial_position time of the initial state from the first point of the previous solution (s)
+     */
+    void setSolution(const State grid_solution[], const float time_initial_position, const bool first_time_solving);
+    /** \brief camera pitch residual of the ACADO LSQ term and its gradient with respect to the position. The QP backends linearize it
+     */
+    double pitchResidual(const Eigen::Vector3d &position, const Eigen::Vector3d &target, Eigen::Vector3d &gradient) const;
 
 
 public:
@@ -51,7 +84,54 @@ public:
     std::unique_ptr<State[]> solution_;
 
     Solver(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> initial_guess);
-    virtual int solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position = 0, bool first_time_solving = true, const int _drone_id = 1, const bool _target = true, const bool _multi = false);
+    /** \brief state where the solver starts. The uav pose the first time. Otherwise, the previous solution interpolated at the time the new one starts
+     *  \param time_initial_position time of the initial state from the first point of the previous solution (s)
+     */
+    State initialState(std::map<int,UavState> &_uavs_pose, const float time_initial_position, const bool first_time_solving, const int _drone_id) const;
+    /** \brief time of the first point of the new solution from the first point of the previous one (s), if it was not the first time
+     */
+    double solutionStart(const float time_initial_position) const { return time_initial_position - offset_*step_size; }
+    void setOptions(const SolverOptions &options){ options_ = options; }
+    /** \brief complete a trajectory braking every axis as hard as the acceleration bound lets, until it hovers
+     *  \param trajectory states of the trajectory. The state at from is kept, its acceleration and the next states are calculated
+     *  \param from last state that is kept
+     *  \param size length of the trajectory
+     */
+    static void brake(State trajectory[], const int from, const int size, const double step_size, const double max_acc);
+    /** \brief state of a trajectory at any time. The accelerations are constant along each step, so it is exact for the solutions of the solvers
+     *  \param time time from the first point (s). It is saturated to the trajectory
+     */
+    static State interpolate(const State trajectory[], const int size, const double time, const double step_size);
+    /** \brief move the start of a trajectory in time, interpolating it. The points out of the trajectory keep its first or last state
+     *  \param time new start from the first point (s)
+     */
+    static void shift(State trajectory[], const int size, const double time, const double step_size);
+    /** \brief non uniform time grid, fine in the near term and coarse at the end of the horizon, with the same look-ahead
+     *  \param steps step of every part of the grid and time where it ends: {step_1, end_1, step_2, end_2, ..., step_n}. The last step
+     *               goes on until the duration
+     *  \param duration time of the last node (s)
+     *  \return times of the nodes from 0. Empty if the steps are not valid
+     */
+    static std::vector<double> timeGrid(const std::vector<double> &steps, const double duration);
+    /** \brief time grid of a move blocking: the acceleration is constant along blocks of steps that grow along the horizon. The nodes are
+     *         on the steps, so the solution is exact every step
+     *  \param blocks steps of every block. The last one is repeated until the end of the horizon
+     *  \param time_horizon number of steps
+     *  \return times of the nodes from 0. Empty if the blocks are not valid
+     */
+    static std::vector<double> blockingGrid(const std::vector<int> &blocks, const int time_horizon, const double step_size);
+    /** \brief position of a trajectory of odometries at any time, linear between its points. It is exact for the constant velocity
+     *         prediction of the target. The time is saturated to the trajectory
+     */
+    static geometry_msgs::Point interpolate(const std::vector<nav_msgs::Odometry> &trajectory, const double time, const double step_size);
+    /** \brief trajectory every step from the nodes of a non uniform grid. The states are exact at every step, and the acceleration of a
+     *         step is its mean acceleration, so the velocities of the next step are exact too
+     *  \param nodes states at the times of the grid. The acceleration of a node is kept until the next one
+     *  \param times times of the nodes (s)
+     *  \param trajectory output, size states
+     */
+    static void toUniform(const State nodes[], const std::vector<double> &times, State trajectory[], const int size, const double step_size);
+    virtual int solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position = 0, bool first_time_solving = true, const int _drone_id = 1, const bool _target = true, const bool _multi = false);
 };
 
 }
@@ -2,6 +2,7 @@
 #define SOLVERACADO_H
 
 #include<solver.h>
+#include<solver_backend.h>
 
 namespace NumericalSolver{
 
@@ -19,12 +20,15 @@ public:
     *  \param desired_pose         Desired position
     *  \param obst                 No fly zone
     *  \param target_vel           [target_vx target_vy targe_vz] We guess velocity constant target
+    *  \param reference_trajectory desired pose at each step. If it is not empty, it is tracked along the whole horizon besides the end term
     *  \TODO m                     manage priorities by drones (ID)
     */
-    int solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position = 0, bool first_time_solving = true, const int _drone_id = 1, const bool _target = true, const bool _multi = false);
+    int solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position = 0, bool first_time_solving = true, const int _drone_id = 1, const bool _target = true, const bool _multi = false);
 
 };
 
+typedef SolverPlugin<ACADOSolver> ACADOBackend;
+
 }
 
 #endif
\ No newline at end of file
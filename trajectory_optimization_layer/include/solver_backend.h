@@ -0,0 +1,100 @@
+#ifndef SOLVER_BACKEND_H
+#define SOLVER_BACKEND_H
+
+#include <solver.h>
+#include <chrono>
+
+namespace NumericalSolver{
+
+/** Problem of one planning cycle, as the backend receives it
+ */
+struct SolverProblem{
+    nav_msgs::Odometry &desired_odometry;
+    const std::vector<float> &no_fly_zone;                      /**< center of the no fly zone */
+    const std::vector<nav_msgs::Odometry> &target_trajectory;    /**< predicted target trajectory */
+    const std::vector<nav_msgs::Odometry> &reference_trajectory; /**< shot reference, empty if it is not tracked */
+    std::map<int,UavState> &uavs_pose;
+    float time_initial_position;                                 /**< time of the initial state from the first point of the previous solution (s) */
+    bool first_time_solving;
+    int drone_id;
+    bool target;
+    bool multi;
+};
+
+/** Outcome of a solve
+ */
+struct SolverResult{
+    int status = -1;            /**< status code of the backend (ACADO returnValueType, FORCES exitflag...) */
+    bool success = false;       /**< the solution can be followed */
+    double solving_time = 0.0;  /**< wall time of the solve (s) */
+    bool converged = false;     /**< the solver reached its tolerances, it was not stopped by its time or iteration limit */
+};
+
+/** Interface of the solver backends. They are pluginlib plugins (solver_plugins.xml) selected with the solver_backend param, so the
+ * backends can be compared without recompiling. pluginlib creates them with the default constructor, so the horizon is given in initialize()
+ */
+class SolverBackend{
+
+public:
+    virtual ~SolverBackend(){}
+
+    /** \brief allocate the solver
+     *  \param solving_rate rate of the planning cycles (Hz)
+     *  \param time_horizon number of steps
+     *  \param initial_guess initial guess of each solve, shared with the owner that fills it
+     */
+    virtual void initialize(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess) = 0;
+    virtual SolverResult solve(SolverProblem &problem) = 0;
+    /** \brief options of the next solves. A backend ignores the ones it does not support */
+    virtual void setOptions(const SolverOptions &options) = 0;
+    /** \brief solved trajectory, time_horizon states. The next solve is spliced with it, so the owner can overwrite it with a solution
+     *         obtained in another way (fast solvers, cache)
+     */
+    virtual State *solution() = 0;
+    /** \brief state where the next solve starts */
+    virtual State initialState(std::map<int,UavState> &uavs_pose, const float time_initial_position, const bool first_time_solving, const int drone_id) const = 0;
+    /** \brief time of the first point of the next solution from the first point of the current one (s), if it is not the first time */
+    virtual double solutionStart(const float time_initial_position) const = 0;
+
+protected:
+    SolverBackend(){}
+};
+
+/** Backend of a NumericalSolver::Solver. Its status is an ACADO returnValueType
+ */
+template<class SolverType>
+class SolverPlugin : public SolverBackend{
+
+public:
+    void initialize(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess) override{
+        solver_ = std::make_unique<SolverType>(solving_rate, time_horizon, initial_guess);
+    }
+
+    SolverResult solve(SolverProblem &problem) override{
+        SolverResult result;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        result.status = solver_->solverFunction(problem.desired_odometry, problem.no_fly_zone, problem.target_trajectory, problem.reference_trajectory, problem.uavs_pose,
+                                                problem.time_initial_position, problem.first_time_solving, problem.drone_id, problem.target, problem.multi);
+        result.solving_time = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        result.success = result.status == returnValueType::SUCCESSFUL_RETURN || result.status == returnValueType::RET_MAX_TIME_REACHED;
+        result.converged = result.status == returnValueType::SUCCESSFUL_RETURN;
+        return result;
+    }
+
+    void setOptions(const SolverOptions &options) override{ solver_->setOptions(options); }
+
+    State *solution() override{ return solver_->solution_.get(); }
+
+    State initialState(std::map<int,UavState> &uavs_pose, const float time_initial_position, const bool first_time_solving, const int drone_id) const override{
+        return solver_->initialState(uavs_pose, time_initial_position, first_time_solving, drone_id);
+    }
+
+    double solutionStart(const float time_initial_position) const override{ return solver_->solutionStart(time_initial_position); }
+
+protected:
+    std::unique_ptr<SolverType> solver_;
+};
+
+}
+
+#endif
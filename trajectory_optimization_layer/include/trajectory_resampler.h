@@ -0,0 +1,56 @@
+#ifndef TRAJECTORY_RESAMPLER_H
+#define TRAJECTORY_RESAMPLER_H
+
+#include <UAVState.h>
+#include <Eigen/Eigen>
+#include <vector>
+
+namespace SolverUtils{
+
+/**
+ * Resampling of a solution at the rate of the tracker. Between two points the solver model is a double integrator with constant
+ * acceleration, so the trajectory is a piecewise quadratic in position (linear in velocity), continuous in position and velocity.
+ * It is evaluated at every output_step from the first point, with the same model, so the dense trajectory is the one the solver planned,
+ * not an approximation of it. Yaw and pitch are given per point and interpolated linearly, unwrapping the yaw.
+ *
+ * The segment and time in the segment of every sample are precomputed. Online, the polynomial coefficients of the segments are gathered
+ * and all the samples are evaluated at once with Eigen array operations.
+ */
+class TrajectoryResampler{
+
+public:
+    /** columns of the coefficients and of the output */
+    enum Column{ PX, PY, PZ, VX, VY, VZ, AX, AY, AZ, YAW, YAW_RATE, PITCH, PITCH_RATE, N_COLUMNS };
+
+    /** \param time_horizon maximum number of points of the input trajectory
+     *  \param step_size time between the input points (s)
+     *  \param output_step time between the output samples (s)
+     */
+    TrajectoryResampler(const int time_horizon, const double step_size, const double output_step);
+
+    /** \brief resample a trajectory from its first point
+     *  \param trajectory input points, one every step_size
+     *  \param size number of input points, not more than the time horizon
+     *  \param yaw yaw of every input point
+     *  \param pitch pitch of every input point
+     *  \return number of samples. The samples are the first rows of samples(), one every output_step
+     */
+    int resample(const State trajectory[], const int size, const double yaw[], const double pitch[]);
+
+    /** \brief samples of the last resample: position, velocity, acceleration, yaw and pitch in the columns PX..AZ, YAW and PITCH
+     */
+    const Eigen::Matrix<double, Eigen::Dynamic, N_COLUMNS> &samples() const { return samples_; }
+    double outputStep() const { return output_step_; }
+
+private:
+    const double step_size_;
+    const double output_step_;
+    std::vector<int> segment_;                                   /**< input point where every sample starts */
+    Eigen::ArrayXd tau_;                                          /**< time of every sample from the start of its segment (s) */
+    Eigen::Matrix<double, Eigen::Dynamic, N_COLUMNS> coefficients_; /**< polynomial coefficients of every segment */
+    Eigen::Matrix<double, Eigen::Dynamic, N_COLUMNS> samples_;
+};
+
+}
+
+#endif
@@ -61,7 +61,7 @@ model.xinitidx = 4:9;
 
 
 %% Define solver options
-codeoptions = getOptions('FORCESNLPsolver');
+codeoptions = getOptions(sprintf('FORCESNLPsolver_%d', model.N)); % one name per horizon, see forces_models.h
 codeoptions.showinfo = 0;
 codeoptions.nohash = 1;
 codeoptions.overwrite = 1;
@@ -177,7 +177,7 @@ problem.all_parameters= aux';
 problem.xinit = [drone_1(1); drone_1(2); drone_1(3); 0; 0; 0;];
 
 % Time to solve the NLP!
-[output,exitflag,info] = FORCESNLPsolver(problem);
+[output,exitflag,info] = feval(codeoptions.name, problem);
 
 % Make sure the solver has exited properly.
 %assert(exitflag == 1,'Some problem in FORCES solver');
@@ -261,7 +261,7 @@ problem.all_parameters= aux';
 problem.xinit = [drone_2(1); drone_2(2); drone_2(3); 0; 0; 0;];
 
 % Time to solve the NLP!
-[output,exitflag,info] = FORCESNLPsolver(problem);
+[output,exitflag,info] = feval(codeoptions.name, problem);
 
 % Make sure the solver has exited properly.
 %assert(exitflag == 1,'Some problem in FORCES solver');
@@ -347,7 +347,7 @@ problem.all_parameters= aux';
 problem.xinit = [drone_3(1); drone_3(2); drone_3(3); 0; 0; 0;];
 
 % Time to solve the NLP!
-[output,exitflag,info] = FORCESNLPsolver(problem);
+[output,exitflag,info] = feval(codeoptions.name, problem);
 
 % Make sure the solver has exited properly.
 %assert(exitflag == 1,'Some problem in FORCES solver');
@@ -0,0 +1,25 @@
+#include <allocation_counter.h>
+
+namespace {
+
+SolverUtils::AllocationCounter::Source allocations_source = nullptr;
+SolverUtils::AllocationCounter::Source bytes_source       = nullptr;
+
+}  // namespace
+
+void SolverUtils::AllocationCounter::install(const Source allocations, const Source bytes) {
+  allocations_source = allocations;
+  bytes_source       = bytes;
+}
+
+bool SolverUtils::AllocationCounter::enabled() {
+  return allocations_source != nullptr;
+}
+
+uint64_t SolverUtils::AllocationCounter::allocations() {
+  return allocations_source ? allocations_source() : 0;
+}
+
+uint64_t SolverUtils::AllocationCounter::bytes() {
+  return bytes_source ? bytes_source() : 0;
+}
@@ -0,0 +1,81 @@
+#include <allocation_counter.h>
+#include <cerrno>
+#include <cstdlib>
+
+// Counter of the allocations of every thread, installed in AllocationCounter. It is linked only in the executables that measure the
+// allocations (allocation_interposer in CMakeLists.txt), never in the libraries: it replaces the malloc family of the whole process, and
+// its initial-exec TLS is only valid in the executable or the libraries loaded at startup
+
+// glibc allocator, the functions below interpose the malloc family of the whole process: operator new, Eigen, ACADO and the C code
+// of the generated solvers allocate through them
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void  __libc_free(void *pointer);
+}
+
+namespace {
+
+// initial-exec: the counters are read without calling the TLS resolver, which could allocate itself
+__thread uint64_t thread_allocations __attribute__((tls_model("initial-exec"))) = 0;
+__thread uint64_t thread_bytes __attribute__((tls_model("initial-exec")))       = 0;
+
+inline void count(const size_t size) {
+  thread_allocations++;
+  thread_bytes += size;
+}
+
+uint64_t threadAllocations() {
+  return thread_allocations;
+}
+
+uint64_t threadBytes() {
+  return thread_bytes;
+}
+
+const bool installed = (SolverUtils::AllocationCounter::install(&threadAllocations, &threadBytes), true);
+
+}  // namespace
+
+extern "C" {
+
+void *malloc(size_t size) {
+  count(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count_, size_t size) {
+  count(count_ * size);
+  return __libc_calloc(count_, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+  count(size);
+  return __libc_realloc(pointer, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+  count(size);
+  return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  count(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size) {
+  if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  count(size);
+  *pointer = __libc_memalign(alignment, size);
+  return *pointer ? 0 : ENOMEM;
+}
+
+void free(void *pointer) {
+  __libc_free(pointer);
+}
+}
@@ -0,0 +1,62 @@
+#include <axis_mpc.h>
+
+NumericalSolver::AxisMPC::AxisMPC(const AxisParameters &parameters) : parameters_(parameters) {
+  const int    N = parameters_.time_horizon;
+  const int    n = N - 2;  // a_0 is fixed and a_N-1 does not change the states
+  const double h = parameters_.step_size;
+
+  // v_k = v0 + h*a0 + h*sum(a_j, 0<j<k),  p_N-1 = p0 + (N-1)*h*v0 + h^2*sum((N-1-j-0.5)*a_j, j<N-1)
+  gamma_v_     = Eigen::MatrixXd::Zero(N - 1, n);
+  gamma_p_end_ = Eigen::VectorXd::Zero(n);
+  for (int i = 0; i < n; i++) {
+    for (int k = i + 2; k < N; k++) {
+      gamma_v_(k - 1, i) = h;
+    }
+    gamma_p_end_(i) = h * h * (N - 1 - (i + 1) - 0.5);
+  }
+
+  Eigen::MatrixXd A(n + N - 1, n);
+  A << Eigen::MatrixXd::Identity(n, n), gamma_v_;
+  const Eigen::MatrixXd P = 2 * parameters_.w_acc * Eigen::MatrixXd::Identity(n, n) + 2 * parameters_.w_end * gamma_p_end_ * gamma_p_end_.transpose();
+  qp_                     = std::make_unique<DenseQP>(P, A);
+}
+
+bool NumericalSolver::AxisMPC::solve(const double displacement, const double v0, const double a0, Eigen::VectorXd &acc) {
+  const int    N  = parameters_.time_horizon;
+  const int    n  = N - 2;
+  const double h  = parameters_.step_size;
+  const double v1 = v0 + h * a0;  // fixed by the initial state
+  if (fabs(a0) > parameters_.max_acc || fabs(v0) > parameters_.max_vel || fabs(v1) > parameters_.max_vel) {
+    return false;
+  }
+  const double          p_end_fixed = (N - 1) * h * v0 + h * h * (N - 1.5) * a0;
+  const Eigen::VectorXd q           = 2 * parameters_.w_end * (p_end_fixed - displacement) * gamma_p_end_;
+
+  Eigen::VectorXd l(n + N - 1), u(n + N - 1);
+  l << Eigen::VectorXd::Constant(n, -parameters_.max_acc), Eigen::VectorXd::Constant(N - 1, -parameters_.max_vel - v1);
+  u << Eigen::VectorXd::Constant(n, parameters_.max_acc), Eigen::VectorXd::Constant(N - 1, parameters_.max_vel - v1);
+
+  if (acc.size() == N) {  // warm start
+    x_ = acc.segment(1, n);
+  }
+  if (qp_->solve(q, l, u, x_) < 0) {
+    return false;
+  }
+  acc.resize(N);
+  acc << a0, x_.cwiseMax(-parameters_.max_acc).cwiseMin(parameters_.max_acc), 0.0;
+  return true;
+}
+
+void NumericalSolver::AxisMPC::integrate(const AxisParameters &parameters, const double p0, const double v0, const Eigen::VectorXd &acc, Eigen::VectorXd &position,
+                                         Eigen::VectorXd &velocity) {
+  const int    N = parameters.time_horizon;
+  const double h = parameters.step_size;
+  position.resize(N);
+  velocity.resize(N);
+  position(0) = p0;
+  velocity(0) = v0;
+  for (int k = 0; k < N - 1; k++) {
+    position(k + 1) = position(k) + h * velocity(k) + 0.5 * h * h * acc(k);
+    velocity(k + 1) = velocity(k) + h * acc(k);
+  }
+}
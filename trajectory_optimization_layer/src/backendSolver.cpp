@@ -1,6 +1,10 @@
 #include <backendSolver.h>
 #include <iostream>
 #include <logger.h>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <ros/callback_queue.h>
 
 
 
@@ -38,6 +42,75 @@ backendSolver::backendSolver(ros::NodeHandle pnh, ros::NodeHandle nh, const int
   } else {
     ROS_ERROR("fail to get solver rate");
   }
+  if (ros::param::has("~tracking_cost")) {
+    ros::param::get("~tracking_cost", tracking_cost_);
+  }
+  if (ros::param::has("~fallback_time_budget")) {
+    ros::param::get("~fallback_time_budget", fallback_time_budget_);
+  }
+  if (fallback_time_budget_.size() != SHIFTED_PLAN) {
+    ROS_ERROR("fallback_time_budget needs %d values, one per solver level. Using the default ones", SHIFTED_PLAN);
+    fallback_time_budget_ = {0.5, 0.25, 0.15};
+  }
+  // non uniform nodes: {step_1, end_1, ..., step_n}, e.g. [0.1, 1.0, 0.5] is 0.1 s for the first second and 0.5 s after
+  std::vector<double> time_grid_steps;
+  if (ros::param::has("~time_grid")) {
+    ros::param::get("~time_grid", time_grid_steps);
+  }
+  if (!time_grid_steps.empty()) {
+    time_grid_ = NumericalSolver::Solver::timeGrid(time_grid_steps, (time_horizon_ - 1) * step_size);
+    if (time_grid_.empty()) {
+      ROS_ERROR("time_grid needs positive steps and the end time of each one but the last. Using a uniform grid");
+    } else {
+      ROS_INFO("Solver %d: %zu nodes in the time grid instead of %d", drone_id_, time_grid_.size(), time_horizon_);
+    }
+  }
+  // move blocking: steps of the blocks with constant acceleration, e.g. [1, 1, 1, 1, 1, 2, 2, 2, 4]. It sets the time grid
+  std::vector<int> move_blocking;
+  if (ros::param::has("~move_blocking")) {
+    ros::param::get("~move_blocking", move_blocking);
+  }
+  if (!move_blocking.empty()) {
+    if (!time_grid_.empty()) {
+      ROS_WARN("Solver %d: move_blocking replaces time_grid", drone_id_);
+    }
+    time_grid_ = NumericalSolver::Solver::blockingGrid(move_blocking, time_horizon_, step_size);
+    if (time_grid_.empty()) {
+      ROS_ERROR("move_blocking needs positive block lengths. Using a uniform grid");
+    } else {
+      ROS_INFO("Solver %d: %zu blocks of constant acceleration instead of %d steps", drone_id_, time_grid_.size() - 1, time_horizon_ - 1);
+    }
+  }
+  if (ros::param::has("~discrete_dynamics")) {
+    ros::param::get("~discrete_dynamics", discrete_dynamics_);
+  }
+  if (discrete_dynamics_ && !time_grid_.empty()) {
+    ROS_WARN("Solver %d: discrete_dynamics needs a uniform grid, it is ignored with %s", drone_id_,
+             move_blocking.empty() ? "time_grid" : "move_blocking");
+  }
+  if (ros::param::has("~max_shifted_cycles")) {
+    ros::param::get("~max_shifted_cycles", max_shifted_cycles_);
+  }
+  if (ros::param::has("~lock_memory")) {
+    ros::param::get("~lock_memory", lock_memory_);
+  }
+  // real-time profile of the threads
+  if (ros::param::has("~realtime_priority")) {
+    ros::param::get("~realtime_priority", solver_profile_.priority);
+  }
+  if (ros::param::has("~solver_cpus")) {
+    ros::param::get("~solver_cpus", solver_profile_.cpus);
+  }
+  if (ros::param::has("~callback_thread")) {
+    ros::param::get("~callback_thread", callback_thread_);
+  }
+  if (ros::param::has("~callback_cpus")) {
+    ros::param::get("~callback_cpus", callback_profile_.cpus);
+  }
+  bool solution_cache = false;
+  if (ros::param::has("~solution_cache")) {
+    ros::param::get("~solution_cache", solution_cache);
+  }
 
   if (no_fly_zone_center_.size() == 2) {
     calculateNoFlyZonePoints(no_fly_zone_center_[0], no_fly_zone_center_[1], NO_FLY_ZONE_RADIUS);
@@ -50,19 +123,121 @@ backendSolver::backendSolver(ros::NodeHandle pnh, ros::NodeHandle nh, const int
   desired_pose_sub = nh.subscribe<shot_executer::DesiredShot>("shot_executer_node/desired_pose", 1, &backendSolver::desiredPoseCallback, this);  // desired pose from shot executer
   // publishers
   solved_trajectory_pub  = pnh.advertise<optimal_control_interface::Solver>("trajectory", 1);
+  metrics_pub            = pnh.advertise<optimal_control_interface::PlannerMetrics>("metrics", 1);
+  cycle_statistics_pub   = pnh.advertise<optimal_control_interface::CycleStatistics>("cycle_statistics", 1);
+
+  // solver backend, loaded as a plugin
+  std::string solver_backend = "optimal_control_interface/acado";
+  if (ros::param::has("~solver_backend")) {
+    ros::param::get("~solver_backend", solver_backend);
+  }
+  solver_loader_ = std::make_unique<pluginlib::ClassLoader<NumericalSolver::SolverBackend>>("optimal_control_interface", "NumericalSolver::SolverBackend");
+  try {
+    solver_pt_ = solver_loader_->createInstance(solver_backend);
+  } catch (pluginlib::PluginlibException &e) {
+    ROS_ERROR("Solver %d: solver backend %s can't be loaded (%s). Using ACADO", drone_id_, solver_backend.c_str(), e.what());
+    solver_pt_ = boost::make_shared<NumericalSolver::ACADOBackend>();
+  }
+  solver_pt_->initialize(solver_rate_, time_horizon, initial_guess_);
+  ROS_INFO("Solver %d: solver backend %s", drone_id_, solver_backend.c_str());
+
+  // explicit MPC for the waypoint shots, if its table has been generated (explicit_mpc_generator)
+  std::string explicit_mpc_file;
+  if (ros::param::has("~explicit_mpc_file")) {
+    ros::param::get("~explicit_mpc_file", explicit_mpc_file);
+  }
+  if (!explicit_mpc_file.empty()) {
+    explicit_mpc_ = std::make_unique<NumericalSolver::ExplicitMPC>(solver_rate_, time_horizon, initial_guess_);
+    if (explicit_mpc_->load(explicit_mpc_file)) {
+      ROS_INFO("Solver %d: explicit MPC table loaded from %s", drone_id_, explicit_mpc_file.c_str());
+    } else {
+      ROS_ERROR("Solver %d: explicit MPC table %s can't be read or it was generated for another problem. Using only the NLP solver", drone_id_,
+                explicit_mpc_file.c_str());
+      explicit_mpc_.reset();
+    }
+  }
+
+  // per-axis solver for the legs without target
+  bool decoupled_solver = false;
+  if (ros::param::has("~decoupled_solver")) {
+    ros::param::get("~decoupled_solver", decoupled_solver);
+  }
+  if (decoupled_solver) {
+    decoupled_solver_ = std::make_unique<NumericalSolver::DecoupledSolver>(solver_rate_, time_horizon, initial_guess_);
+  }
 
-  // acado object
-  solver_pt_ = std::make_unique<NumericalSolver::ACADOSolver>(solver_rate_, time_horizon, initial_guess_);
+  // solution cache, persistent if a file is given
+  if (solution_cache) {
+    int solution_cache_size = 256;
+    if (ros::param::has("~solution_cache_size")) {
+      ros::param::get("~solution_cache_size", solution_cache_size);
+    }
+    solution_cache_ = std::make_unique<SolverUtils::SolutionCache>(time_horizon, solution_cache_size);
+    cached_solution_.resize(time_horizon);
+    std::string solution_cache_file;
+    if (ros::param::has("~solution_cache_file")) {
+      ros::param::get("~solution_cache_file", solution_cache_file);
+    }
+    if (!solution_cache_file.empty()) {
+      solution_cache_->load(solution_cache_file);
+    }
+  }
+
+  // capture of the planning steps to replay them offline (replay_solver)
+  std::string capture_file;
+  if (ros::param::has("~capture_file")) {
+    ros::param::get("~capture_file", capture_file);
+  }
+  if (!capture_file.empty()) {
+    problem_recorder_ = std::make_unique<SolverUtils::ProblemRecorder>(time_horizon);
+    if (problem_recorder_->open(capture_file)) {
+      ROS_INFO("Solver %d: capturing the planning steps in %s", drone_id_, capture_file.c_str());
+    } else {
+      problem_recorder_.reset();
+    }
+  }
 
   // log files
   logger = new SolverUtils::Logger(this,pnh);
+
+  warmUp();
+  // after the warm-up, so the pages that the cycle uses are already mapped
+  if (lock_memory_) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+      ROS_INFO("Solver %d: memory locked", drone_id_);
+    } else {
+      ROS_WARN("Solver %d: the memory can't be locked (%s). It needs CAP_IPC_LOCK or a memlock limit", drone_id_, strerror(errno));
+    }
+  }
 }
 
+backendSolver::backendSolver(const int time_horizon, const float solver_rate, const int drone_id) : time_horizon_(time_horizon),
+                                                                                                  solution_(new State[time_horizon]),
+                                                                                                  initial_guess_(new State[time_horizon]),
+                                                                                                  drone_id_(drone_id),
+                                                                                                  solver_rate_(solver_rate),
+                                                                                                  logger(nullptr) {
+  // no params, topics or log files. The state is set directly by the owner of the object
+  drones.push_back(drone_id_);
+  solver_pt_ = boost::make_shared<NumericalSolver::ACADOBackend>();
+  solver_pt_->initialize(solver_rate_, time_horizon, initial_guess_);
+}
+
+backendSolver::~backendSolver() {
+  stop_callbacks_ = true;
+  if (callback_spinner_.joinable()) {
+    callback_spinner_.join();
+  }
+}
 
-void backendSolver::desiredPoseCallback(const shot_executer::DesiredShot::ConstPtr &msg) {
 
-  desired_odometry_ = msg->desired_odometry;
-  desired_type_     = msg->type;
+void backendSolver::desiredPoseCallback(const shot_executer::DesiredShot::ConstPtr &msg) {
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
+  received_.desired_odometry = msg->desired_odometry;
+  received_.desired_type     = msg->type;
+  if (tracking_cost_) {
+    received_.reference_trajectory = msg->reference_trajectory;
+  }
   // ROS_INFO("Desired pose received: x: %f y: %f z: %f",msg->pose.pose.orientation.x,msg->pose.pose.orientation.y,msg->pose.pose.orientation.z]);
 }
 
@@ -70,21 +245,22 @@ void backendSolver::desiredPoseCallback(const shot_executer::DesiredShot::ConstP
 
 void backendSolver::saveCalculatedTrajectory(){
   for (int i=0; i<time_horizon_; i++){
-      solution_[i].pose.x = solver_pt_->solution_[i].pose.x;
-      solution_[i].pose.y = solver_pt_->solution_[i].pose.y;
-      solution_[i].pose.z = solver_pt_->solution_[i].pose.z;
-      solution_[i].velocity.x = solver_pt_->solution_[i].velocity.x;
-      solution_[i].velocity.y = solver_pt_->solution_[i].velocity.y;
-      solution_[i].velocity.z = solver_pt_->solution_[i].velocity.z;
-      solution_[i].acc.x = solver_pt_->solution_[i].acc.x;
-      solution_[i].acc.y = solver_pt_->solution_[i].acc.y;
-      solution_[i].acc.z = solver_pt_->solution_[i].acc.z;
+      solution_[i].pose.x = solver_pt_->solution()[i].pose.x;
+      solution_[i].pose.y = solver_pt_->solution()[i].pose.y;
+      solution_[i].pose.z = solver_pt_->solution()[i].pose.z;
+      solution_[i].velocity.x = solver_pt_->solution()[i].velocity.x;
+      solution_[i].velocity.y = solver_pt_->solution()[i].velocity.y;
+      solution_[i].velocity.z = solver_pt_->solution()[i].velocity.z;
+      solution_[i].acc.x = solver_pt_->solution()[i].acc.x;
+      solution_[i].acc.y = solver_pt_->solution()[i].acc.y;
+      solution_[i].acc.z = solver_pt_->solution()[i].acc.z;
   }
 }
 
 /** \brief This callback receives the solved trajectory of uavs
  */
 void backendSolver::uavTrajectoryCallback(const optimal_control_interface::Solver::ConstPtr &msg, int id) {
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
   uavs_trajectory[id].positions.clear();
   uavs_trajectory[id].velocities.clear();
   uavs_trajectory[id].accelerations.clear();
@@ -92,13 +268,14 @@ void backendSolver::uavTrajectoryCallback(const optimal_control_interface::Solve
   uavs_trajectory[id].positions     = msg->positions;
   uavs_trajectory[id].velocities    = msg->velocities;
   uavs_trajectory[id].accelerations = msg->accelerations;
-  ROS_INFO("Solver %d: trajectory callback from drone %d", drone_id_, id);
+  TRACE_INFO(1.0, "Solver %.0f: trajectory callback from drone %.0f", drone_id_, id);
 }
 
 /** \brief callback for the pose of uavs
  */
 void backendSolver::uavPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &msg, int id) {
-  uavs_pose_[id].has_pose = true;
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
+  received_.uavs_pose[id].has_pose = true;
   if (!trajectory_solved_received[id]) {
     for (int i = 0; i < time_horizon_; i++) {
       geometry_msgs::PoseStamped pose_aux;
@@ -108,18 +285,18 @@ void backendSolver::uavPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &
       uavs_trajectory[id].positions.push_back(pose_aux);
     }
   }
-  uavs_pose_[id].state.pose.x = msg->pose.position.x;
-  uavs_pose_[id].state.pose.y = msg->pose.position.y;
-  uavs_pose_[id].state.pose.z = msg->pose.position.z;
+  received_.uavs_pose[id].state.pose.x = msg->pose.position.x;
+  received_.uavs_pose[id].state.pose.y = msg->pose.position.y;
+  received_.uavs_pose[id].state.pose.z = msg->pose.position.z;
   
-  uavs_pose_[id].state.quaternion.x = msg->pose.orientation.x;
-  uavs_pose_[id].state.quaternion.y = msg->pose.orientation.y;
-  uavs_pose_[id].state.quaternion.z = msg->pose.orientation.z;
-  uavs_pose_[id].state.quaternion.w = msg->pose.orientation.w;
+  received_.uavs_pose[id].state.quaternion.x = msg->pose.orientation.x;
+  received_.uavs_pose[id].state.quaternion.y = msg->pose.orientation.y;
+  received_.uavs_pose[id].state.quaternion.z = msg->pose.orientation.z;
+  received_.uavs_pose[id].state.quaternion.w = msg->pose.orientation.w;
 }
 
 
-void backendSolver::publishSolvedTrajectory(const std::vector<double> &yaw, const std::vector<double> &pitch, const int delayed_points /*0 default */) {
+void backendSolver::publishSolvedTrajectory(const SolverUtils::ArenaVector<double> &yaw, const SolverUtils::ArenaVector<double> &pitch) {
   ROS_INFO("virtual definition of publish solved trajectory");
 }
 
@@ -133,9 +310,10 @@ bool backendSolver::desiredPoseReached(const std::vector<double> desired_pos, co
     return false;
   }
 }
-std::vector<double> backendSolver::predictingPitch() {
+SolverUtils::ArenaVector<double> backendSolver::predictingPitch() {
 
-  std::vector<double> pitch;
+  SolverUtils::ArenaVector<double> pitch(cycle_arena_.allocator<double>());
+  pitch.reserve(time_horizon_);
 
   Eigen::Vector3f target_pose_aux;
   Eigen::Vector3f drone_pose_aux;
@@ -151,9 +329,10 @@ std::vector<double> backendSolver::predictingPitch() {
 }
 
 /** utility function to move yaw pointing the target*/
-std::vector<double> backendSolver::predictingYaw() {
+SolverUtils::ArenaVector<double> backendSolver::predictingYaw() {
 
-  std::vector<double> yaw;
+  SolverUtils::ArenaVector<double> yaw(cycle_arena_.allocator<double>());
+  yaw.reserve(time_horizon_);
 
   Eigen::Vector3f target_pose_aux;
   Eigen::Vector3f drone_pose_aux;
@@ -164,9 +343,8 @@ std::vector<double> backendSolver::predictingYaw() {
     drone_pose_aux  = Eigen::Vector3f(solution_[i].pose.x,solution_[i].pose.y, solution_[i].pose.z);
     q_camera_target = target_pose_aux - drone_pose_aux;
     yaw.push_back(atan2(q_camera_target[1], q_camera_target[0]));
-    ROS_INFO("[%s]: Estimated target trajectory target = [%.2f, %.2f, %.2f], drone = [%.2f, %.2f, %.2f], yaw = %.2f", ros::this_node::getName().c_str(),
-             target_pose_aux[0], target_pose_aux[1], target_pose_aux[2], drone_pose_aux[0], drone_pose_aux[1], drone_pose_aux[2],
-             atan2(-q_camera_target[1], -q_camera_target[0]));
+    TRACE_DEBUG(0.0, "Estimated target trajectory target = [%.2f, %.2f, %.2f], drone = [%.2f, %.2f, %.2f], yaw = %.2f", target_pose_aux[0], target_pose_aux[1],
+                target_pose_aux[2], drone_pose_aux[0], drone_pose_aux[1], drone_pose_aux[2], atan2(-q_camera_target[1], -q_camera_target[0]));
   }
   return yaw;
 }
@@ -268,7 +446,8 @@ void backendSolver::calculateInitialGuess(bool new_initial_guess) {
       initial_guess_[i].pose.y = initial_guess_[i - 1].pose.y + step_size * initial_guess_[i - 1].velocity.y;
       initial_guess_[i].pose.z = initial_guess_[i - 1].pose.z + step_size * initial_guess_[i - 1].velocity.z;
       // no fly zone
-      if (pow(initial_guess_[i].pose.x - no_fly_zone_center_[0], 2) + pow(initial_guess_[i].pose.y - no_fly_zone_center_[1], 2) < pow(NO_FLY_ZONE_RADIUS, 2)) {
+      if (no_fly_zone_center_.size() == 2 &&
+          pow(initial_guess_[i].pose.x - no_fly_zone_center_[0], 2) + pow(initial_guess_[i].pose.y - no_fly_zone_center_[1], 2) < pow(NO_FLY_ZONE_RADIUS, 2)) {
         aux                     = expandPose(initial_guess_[i].pose.x, initial_guess_[i].pose.y);
         initial_guess_[i].pose.x = aux[0];
         initial_guess_[i].pose.y = aux[1];
@@ -292,7 +471,9 @@ void backendSolver::calculateInitialGuess(bool new_initial_guess) {
   //     initial_guess_["pitch"][i] = 0.3;
   // }
   // log the initial guess
-  logger->logging();
+  if (logger) {
+    logger->logging();
+  }
 }
 
 std::array<float, 2> backendSolver::expandPose(float x, float y) {
@@ -331,84 +512,457 @@ void backendSolver::IDLEState() {
 
 //     }
 // }
-float backendSolver::checkRoundedTime(std::chrono::system_clock::time_point start) {
-  std::chrono::duration<double> diff             = std::chrono::system_clock::now() - start;
-  float rounded_time = round( diff.count() * 10.0 ) / 10.0;
-  return rounded_time;
+float backendSolver::initialTime(const double start_time) const {
+  return first_time_solving_ ? 0.0 : start_time - plan_start_;
+}
+
+void backendSolver::updatePlanStart(const double now, const float initial_time) {
+  if (first_time_solving_) {
+    plan_start_ = now;
+  } else {
+    plan_start_ += solver_pt_->solutionStart(initial_time);
+  }
+}
+
+
+void backendSolver::captureProblem(SolverUtils::ProblemRecorder::Record &record, const float initial_time) {
+  record.time               = plan_start_ + initial_time;
+  record.initial_time       = initial_time;
+  record.drone_id           = drone_id_;
+  record.shot_type          = desired_type_;
+  record.first_time_solving = first_time_solving_;
+  record.target             = target_;
+  record.multi              = multi_;
+  record.options            = solver_options_;
+  record.desired            = SolverUtils::ProblemRecorder::toState(desired_odometry_);
+  record.no_fly_zone        = no_fly_zone_center_;
+  record.previous_solution.assign(solver_pt_->solution(), solver_pt_->solution() + time_horizon_);
+  record.initial_guess.assign(initial_guess_.get(), initial_guess_.get() + time_horizon_);
+  record.target_trajectory.clear();
+  for (const nav_msgs::Odometry &odometry : target_trajectory_) {
+    record.target_trajectory.push_back(SolverUtils::ProblemRecorder::toState(odometry));
+  }
+  record.reference_trajectory.clear();
+  for (const nav_msgs::Odometry &odometry : reference_trajectory_) {
+    record.reference_trajectory.push_back(SolverUtils::ProblemRecorder::toState(odometry));
+  }
+  record.uavs.clear();
+  for (auto it = uavs_pose_.begin(); it != uavs_pose_.end(); it++) {
+    record.uavs.emplace_back(it->first, it->second.state);
+  }
+}
+
+SolverUtils::SolutionCache::Features backendSolver::cacheFeatures(const float initial_time) {
+  SolverUtils::SolutionCache::Features features;
+  const State start = solver_pt_->initialState(uavs_pose_, initial_time, first_time_solving_, drone_id_);
+
+  features[SolverUtils::SolutionCache::X]         = start.pose.x;
+  features[SolverUtils::SolutionCache::Y]         = start.pose.y;
+  features[SolverUtils::SolutionCache::Z]         = start.pose.z;
+  features[SolverUtils::SolutionCache::VX]        = start.velocity.x;
+  features[SolverUtils::SolutionCache::VY]        = start.velocity.y;
+  features[SolverUtils::SolutionCache::VZ]        = start.velocity.z;
+  features[SolverUtils::SolutionCache::DESIRED_X] = desired_odometry_.pose.pose.position.x;
+  features[SolverUtils::SolutionCache::DESIRED_Y] = desired_odometry_.pose.pose.position.y;
+  features[SolverUtils::SolutionCache::DESIRED_Z] = desired_odometry_.pose.pose.position.z;
+  features[SolverUtils::SolutionCache::SHOT_TYPE] = desired_type_;
+  features[SolverUtils::SolutionCache::TARGET_X]  = target_odometry_.pose.pose.position.x;
+  features[SolverUtils::SolutionCache::TARGET_Y]  = target_odometry_.pose.pose.position.y;
+  features[SolverUtils::SolutionCache::TARGET_Z]  = target_odometry_.pose.pose.position.z;
+  features[SolverUtils::SolutionCache::TARGET_VX] = target_odometry_.twist.twist.linear.x;
+  features[SolverUtils::SolutionCache::TARGET_VY] = target_odometry_.twist.twist.linear.y;
+  features[SolverUtils::SolutionCache::TARGET_VZ] = target_odometry_.twist.twist.linear.z;
+  features[SolverUtils::SolutionCache::FIRST_TIME] = first_time_solving_;
+  features[SolverUtils::SolutionCache::TARGET]     = target_;
+  features[SolverUtils::SolutionCache::MULTI]      = multi_;
+  // constraints: no fly zone and the first other uavs, far away if there are not
+  const bool no_fly_zone = no_fly_zone_center_.size() == 2;
+  features[SolverUtils::SolutionCache::NO_FLY_ZONE_X] = no_fly_zone ? no_fly_zone_center_[0] : SolverUtils::SolutionCache::FAR_AWAY;
+  features[SolverUtils::SolutionCache::NO_FLY_ZONE_Y] = no_fly_zone ? no_fly_zone_center_[1] : SolverUtils::SolutionCache::FAR_AWAY;
+  std::fill(&features[SolverUtils::SolutionCache::UAV_1_X], &features[SolverUtils::SolutionCache::UAV_2_Z] + 1, SolverUtils::SolutionCache::FAR_AWAY);
+  int uav = 0;
+  for (auto it = uavs_pose_.begin(); it != uavs_pose_.end() && uav < SolverUtils::SolutionCache::OTHER_UAVS; it++) {
+    if (it->first != drone_id_ && it->second.has_pose) {
+      features[SolverUtils::SolutionCache::UAV_1_X + 3 * uav]     = it->second.state.pose.x;
+      features[SolverUtils::SolutionCache::UAV_1_X + 3 * uav + 1] = it->second.state.pose.y;
+      features[SolverUtils::SolutionCache::UAV_1_X + 3 * uav + 2] = it->second.state.pose.z;
+      uav++;
+    }
+  }
+  // shot reference, by its end
+  const bool reference = !reference_trajectory_.empty();
+  features[SolverUtils::SolutionCache::REFERENCE_X]      = reference ? reference_trajectory_.back().pose.pose.position.x : 0.0;
+  features[SolverUtils::SolutionCache::REFERENCE_Y]      = reference ? reference_trajectory_.back().pose.pose.position.y : 0.0;
+  features[SolverUtils::SolutionCache::REFERENCE_Z]      = reference ? reference_trajectory_.back().pose.pose.position.z : 0.0;
+  features[SolverUtils::SolutionCache::REFERENCE_POINTS] = reference_trajectory_.size();
+  return features;
+}
+
+int backendSolver::initialPoint(const float initial_time) const {
+  if (first_time_solving_) {
+    return 0;
+  }
+  const long point = std::lround((initial_time - solver_pt_->solutionStart(initial_time)) / step_size);
+  return std::min<long>(std::max<long>(point, 0), time_horizon_ - 1);
+}
+
+void backendSolver::cacheSolution(const SolverUtils::SolutionCache::Features &features, const float initial_time) {
+  // from the initial state, completed braking
+  const int    start = initialPoint(initial_time);
+  const State *plan  = solver_pt_->solution();
+  std::copy(plan + start, plan + time_horizon_, cached_solution_.begin());
+  NumericalSolver::Solver::brake(cached_solution_.data(), time_horizon_ - 1 - start, time_horizon_, step_size, MAX_BRAKING_ACC);
+  solution_cache_->insert(features, cached_solution_.data());
+}
+
+void backendSolver::anchorCachedSolution(const SolverUtils::SolutionCache::Features &features) {
+  // the same trajectory from the initial state of this problem. A translation keeps the dynamics
+  const double dx = features[SolverUtils::SolutionCache::X] - cached_solution_[0].pose.x;
+  const double dy = features[SolverUtils::SolutionCache::Y] - cached_solution_[0].pose.y;
+  const double dz = features[SolverUtils::SolutionCache::Z] - cached_solution_[0].pose.z;
+  for (State &state : cached_solution_) {
+    state.pose.x += dx;
+    state.pose.y += dy;
+    state.pose.z += dz;
+  }
+}
+
+void backendSolver::spliceCachedSolution(const float initial_time) {
+  // the points followed while planning, as the solvers splice them (Solver::setSolution), and the cached trajectory from the initial state
+  State    *plan  = solver_pt_->solution();
+  const int start = initialPoint(initial_time);
+  if (!first_time_solving_) {
+    NumericalSolver::Solver::shift(plan, time_horizon_, solver_pt_->solutionStart(initial_time), step_size);
+  }
+  std::copy(cached_solution_.begin(), cached_solution_.end() - start, plan + start);
+}
+
+bool backendSolver::fastSolve(NumericalSolver::Solver &fast_solver, const float initial_time, SolverUtils::ProblemRecorder::Record *record) {
+  // the new solution is spliced with the previous one, so it takes it from the NLP solver that keeps the current solution
+  std::copy(solver_pt_->solution(), solver_pt_->solution() + time_horizon_, fast_solver.solution_.get());
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  solver_success = fast_solver.solverFunction(desired_odometry_, no_fly_zone_center_, target_trajectory_, reference_trajectory_, uavs_pose_, initial_time,
+                                              first_time_solving_, drone_id_, target_);
+  if (solver_success != returnValueType::SUCCESSFUL_RETURN) {
+    return false;
+  }
+  solver_result_.status       = solver_success;
+  solver_result_.success      = true;
+  solver_result_.solving_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (record) {
+    captureProblem(*record, initial_time);
+  }
+  std::copy(fast_solver.solution_.get(), fast_solver.solution_.get() + time_horizon_, solver_pt_->solution());
+  return true;
+}
+
+int backendSolver::planningStep(const float initial_time) {
+  // predict the target trajectory if it exists
+  if (target_) {
+    targetTrajectoryVelocityCTEModel();
+  }
+  // if it is the first time or the previous time the solver couldn't success, don't take previous trajectory as initial guess
+  calculateInitialGuess(first_time_solving_ || change_initial_guess_);
+
+  SolverUtils::ProblemRecorder::Record *record = problem_recorder_ ? problem_recorder_->begin() : nullptr;
+
+  // waypoint shots are evaluated with the explicit MPC if they are inside its table. The table has no camera pitch term, so the shots
+  // that film the target are left to the NLP solver. The reference is not enough to tell them: it is empty without tracking_cost
+  bool solved = false;
+  const bool waypoint = desired_type_ == shot_executer::DesiredShot::GOTO || !target_;
+  if (explicit_mpc_ && waypoint && reference_trajectory_.empty()) {
+    solved = fastSolve(*explicit_mpc_, initial_time, record);
+  }
+  // legs without target are three independent axes
+  if (!solved && decoupled_solver_ && NumericalSolver::DecoupledSolver::isDecoupled(target_trajectory_, reference_trajectory_, target_)) {
+    solved = fastSolve(*decoupled_solver_, initial_time, record);
+  }
+
+  if (!solved) {
+    // search the problem in the cache. A hit is the answer, a near miss is a better initial guess
+    SolverUtils::SolutionCache::Features     features;
+    SolverUtils::SolutionCache::LookupResult cache_result = SolverUtils::SolutionCache::MISS;
+    if (solution_cache_) {
+      features     = cacheFeatures(initial_time);
+      cache_result = solution_cache_->lookup(features, cached_solution_.data());
+    }
+    if (cache_result != SolverUtils::SolutionCache::MISS) {
+      anchorCachedSolution(features);
+    }
+    // the initial guess is on the solver grid from the initial state, as the cached trajectory
+    if (cache_result == SolverUtils::SolutionCache::WARM_START) {
+      std::copy(cached_solution_.begin(), cached_solution_.end(), initial_guess_.get());
+    }
+    // input of the solver, with the final initial guess and before the current solution changes
+    if (record) {
+      captureProblem(*record, initial_time);
+    }
+    if (cache_result == SolverUtils::SolutionCache::HIT) {
+      spliceCachedSolution(initial_time);
+      solver_success = returnValueType::SUCCESSFUL_RETURN;
+      solver_result_ = {solver_success, true, 0.0};
+    } else {
+      // call the solver
+      NumericalSolver::SolverProblem problem{desired_odometry_, no_fly_zone_center_, target_trajectory_, reference_trajectory_, uavs_pose_,
+                                             initial_time, first_time_solving_, drone_id_, target_, false};
+      solver_result_ = solver_pt_->solve(problem);
+      solver_success = solver_result_.status;
+      // only the converged solutions of the nominal problem, not the ones cut by the time budget nor the relaxed levels
+      const bool nominal = solver_options_.tolerance_scale == 1.0 && solver_options_.horizon == 0;
+      if (solution_cache_ && solver_result_.converged && nominal) {
+        cacheSolution(features, initial_time);
+      }
+    }
+  }
+
+  // log solved trajectory
+  if (logger) {
+    logger->loggingCalculatedTrajectory(solver_success);
+  }
+  if (record) {
+    record->status       = solver_success;
+    record->solving_time = solver_result_.solving_time;
+    record->solution.assign(solver_pt_->solution(), solver_pt_->solution() + time_horizon_);
+    problem_recorder_->commit();
+  }
+
+  // if the solver didn't success, change initial guess
+  change_initial_guess_ = !solver_result_.success;
+  return solver_success;
+}
+
+backendSolver::FallbackLevel backendSolver::fallbackLadder(const float initial_time) {
+  const float period = 1 / solver_rate_;
+  // solver levels
+  for (int level = NOMINAL; level < SHIFTED_PLAN; level++) {
+    NumericalSolver::SolverOptions options;
+    options.tolerance_scale   = (level == NOMINAL) ? 1.0 : RELAXED_TOLERANCE_SCALE;
+    options.max_time          = fallback_time_budget_[level] * period;
+    options.horizon           = (level == SHORT_HORIZON) ? time_horizon_ / 2 : 0;
+    options.time_grid         = time_grid_;
+    options.discrete_dynamics = discrete_dynamics_;
+    solver_pt_->setOptions(options);
+    solver_options_ = options;
+    planningStep(initial_time);
+    if (solver_result_.success) {
+      return static_cast<FallbackLevel>(level);
+    }
+    ROS_WARN("Solver %d: fallback level %d failed with status %d", drone_id_, level, solver_success);
+  }
+  // levels without solver
+  if (consecutive_fallbacks_ < (unsigned int)max_shifted_cycles_ && shiftedPlan(initial_time)) {
+    return SHIFTED_PLAN;
+  }
+  brakingPlan(initial_time);
+  return BRAKING;
+}
+
+bool backendSolver::shiftedPlan(const float initial_time) {
+  if (first_time_solving_) {
+    return false;
+  }
+  // the solution of the backend is still the previous plan, because the failed solves don't change it
+  State       *plan  = solver_pt_->solution();
+  const double start = solver_pt_->solutionStart(initial_time);
+  NumericalSolver::Solver::shift(plan, time_horizon_, start, step_size);
+  NumericalSolver::Solver::brake(plan, lastShiftedPoint(start), time_horizon_, step_size, MAX_BRAKING_ACC);
+  return true;
+}
+
+void backendSolver::brakingPlan(const float initial_time) {
+  State *plan = solver_pt_->solution();
+  if (first_time_solving_) {
+    plan[0] = uavs_pose_[drone_id_].state;
+    NumericalSolver::Solver::brake(plan, 0, time_horizon_, step_size, MAX_BRAKING_ACC);
+    return;
+  }
+  // the points followed while planning (as the solver splices them) and then braking
+  const double start = solver_pt_->solutionStart(initial_time);
+  NumericalSolver::Solver::shift(plan, time_horizon_, start, step_size);
+  NumericalSolver::Solver::brake(plan, std::min(BRAKING_KEPT_POINTS - 1, lastShiftedPoint(start)), time_horizon_, step_size, MAX_BRAKING_ACC);
+}
+
+int backendSolver::lastShiftedPoint(const double start) const {
+  return std::min(std::max<int>(time_horizon_ - 1 - start / step_size, 0), time_horizon_ - 1);
+}
+
+void backendSolver::publishMetrics(const FallbackLevel level, const double planning_time) {
+  optimal_control_interface::PlannerMetrics_<SolverUtils::ArenaAllocator<void>> msg(cycle_arena_.allocator<void>());
+  msg.header.stamp          = ros::Time::now();
+  msg.level                 = level;
+  msg.solver_status         = solver_success;
+  msg.planning_time         = planning_time;
+  msg.planning_allocations  = planning_allocations_;
+  msg.consecutive_fallbacks = consecutive_fallbacks_;
+  msg.level_count.assign(fallback_count_.begin(), fallback_count_.end());
+  metrics_pub.publish(msg);
+}
+
+void backendSolver::publishCycleStatistics(const Realtime::CycleStatistics &statistics) {
+  optimal_control_interface::CycleStatistics_<SolverUtils::ArenaAllocator<void>> msg(cycle_arena_.allocator<void>());
+  msg.header.stamp   = ros::Time::now();
+  msg.nominal_period = statistics.nominalPeriod();
+  msg.last_period    = statistics.last();
+  msg.min_period     = statistics.min();
+  msg.max_period     = statistics.max();
+  msg.mean_period    = statistics.mean();
+  msg.jitter         = statistics.jitter();
+  msg.cycles         = statistics.cycles();
+  msg.overruns       = statistics.overruns();
+  msg.bin_width      = statistics.binWidth();
+  msg.histogram.assign(statistics.histogram().begin(), statistics.histogram().end());
+  cycle_statistics_pub.publish(msg);
+}
+
+void backendSolver::startThreads() {
+  // the callback thread first, so it does not inherit the profile of the solver thread
+  if (callback_thread_) {
+    callback_spinner_ = std::thread([this] {
+      std::string error;
+      if (!Realtime::apply(callback_profile_, error)) {
+        ROS_WARN("Solver %d: the cpus of the callback thread can't be set (%s)", drone_id_, error.c_str());
+      }
+      while (ros::ok() && !stop_callbacks_) {
+        ros::getGlobalCallbackQueue()->callAvailable(ros::WallDuration(0.1));
+      }
+    });
+    ROS_INFO("Solver %d: callback thread on cpus %s", drone_id_, Realtime::cpusText(callback_profile_).c_str());
+  }
+  std::string error;
+  if (Realtime::apply(solver_profile_, error)) {
+    ROS_INFO("Solver %d: solver thread with priority %d (0: default scheduler) on cpus %s", drone_id_, solver_profile_.priority,
+             Realtime::cpusText(solver_profile_).c_str());
+  } else {
+    ROS_WARN("Solver %d: the real-time profile of the solver thread can't be set (%s)", drone_id_, error.c_str());
+  }
+}
+
+uint64_t backendSolver::warmUp() {
+  // buffers of the cycle
+  target_trajectory_.reserve(time_horizon_);
+  reference_trajectory_.reserve(time_horizon_);
+
+  // shot filming a target that moves away, from hovering. Everything is local, so the state of the planner does not change
+  std::map<int, UavState> uavs_pose;
+  uavs_pose[drone_id_].has_pose     = true;
+  uavs_pose[drone_id_].state.pose.z = 3.0;
+  nav_msgs::Odometry desired;
+  desired.pose.pose.position.x = 10.0;
+  desired.pose.pose.position.z = 3.0;
+  std::vector<nav_msgs::Odometry> target(time_horizon_), reference;
+  for (int i = 0; i < time_horizon_; i++) {
+    target[i].pose.pose.position.x = 5.0 + step_size * i;
+    target[i].pose.pose.position.z = 1.0;
+    target[i].twist.twist.linear.x = 1.0;
+    initial_guess_[i]              = uavs_pose[drone_id_].state;
+  }
+  NumericalSolver::SolverOptions options;
+  options.max_time          = fallback_time_budget_[NOMINAL] / solver_rate_;
+  options.time_grid         = time_grid_;
+  options.discrete_dynamics = discrete_dynamics_;
+  solver_pt_->setOptions(options);
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  uint64_t                                    allocations = 0;
+  for (int solve = 0; solve < WARM_UP_SOLVES; solve++) {
+    // the next solves start from the previous one, as the cycles after the first one
+    const SolverUtils::AllocationScope scope;
+    NumericalSolver::SolverProblem     problem{desired, no_fly_zone_center_, target, reference, uavs_pose, solve == 0 ? 0.0f : (float)step_size,
+                                           solve == 0, drone_id_, true, false};
+    solver_pt_->solve(problem);
+    allocations = scope.allocations();
+  }
+  if (decoupled_solver_) {
+    decoupled_solver_->solverFunction(desired, no_fly_zone_center_, {}, reference, uavs_pose, 0, true, drone_id_, false);
+  }
+  std::fill(initial_guess_.get(), initial_guess_.get() + time_horizon_, State());
+  const double warm_up_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (!SolverUtils::AllocationCounter::enabled()) {
+    ROS_INFO("Solver %d: warmed up in %f s", drone_id_, warm_up_time);
+  } else if (allocations == 0) {
+    ROS_INFO("Solver %d: warmed up in %f s, the solves are allocation free", drone_id_, warm_up_time);
+  } else {
+    ROS_WARN("Solver %d: warmed up in %f s, a solve still allocates %lu times", drone_id_, warm_up_time, allocations);
+  }
+  return allocations;
 }
 
+void backendSolver::copyInputs() {
+  // the assignments reuse the memory of the previous cycle
+  desired_odometry_     = received_.desired_odometry;
+  desired_type_         = received_.desired_type;
+  reference_trajectory_ = received_.reference_trajectory;
+  target_odometry_      = received_.target_odometry;
+  target_has_pose       = received_.target_has_pose;
+  for (auto it = received_.uavs_pose.begin(); it != received_.uavs_pose.end(); it++) {
+    UavState &uav = uavs_pose_[it->first];
+    uav.state     = it->second.state;
+    uav.has_pose  = it->second.has_pose;
+  }
+}
 
 void backendSolver::stateMachine() {
-  int       closest_point = 0;
   ros::Rate solver_timer(solver_rate_); //Hz
-  bool      loop_rate_violated = false;
-  std::chrono::system_clock::time_point start;
-  std::chrono::duration<double> diff;
-  float actual_cicle_time = 0.0;
-  bool change_initial_guess = true;
-  // int cont =
-  first_time_solving_ = true;
-  
+  first_time_solving_   = true;
+  change_initial_guess_ = true;
+  expected_solve_time_  = fallback_time_budget_[NOMINAL] / solver_rate_;
+  startThreads();
+  Realtime::CycleStatistics cycle_statistics(1 / solver_rate_);
+
   while (ros::ok) {
-    ros::spinOnce();
+    if (!callback_thread_) {
+      ros::spinOnce();
+    }
+    // the inputs of this cycle. With the callback thread, the next ones keep arriving while it solves
+    {
+      std::lock_guard<std::mutex> inputs(inputs_mutex_);
+      copyInputs();
+    }
+    // the scratch data of the previous cycle has been destroyed
+    cycle_arena_.reset();
     if (desired_type_ == shot_executer::DesiredShot::IDLE) { // IDLE STATE
+      cycle_statistics.restart();
       IDLEState();
       std::this_thread::sleep_for(std::chrono::seconds(1));
       continue;
     } else if (desired_type_ == shot_executer::DesiredShot::GOTO || desired_type_ == shot_executer::DesiredShot::SHOT) { // Shooting action
-       
-
-      do {
-        ros::spinOnce();
-        // predict the target trajectory if it exists
-        if (target_) {  
-          targetTrajectoryVelocityCTEModel();
-        }
-        // if it is the first time or the previous time the solver couldn't success, don't take previous trajectory as initial guess
-        calculateInitialGuess(first_time_solving_ || change_initial_guess);
-        
-        // call the solver
-        solver_success = solver_pt_->solverFunction(desired_odometry_, no_fly_zone_center_, target_trajectory_, uavs_pose_, actual_cicle_time, first_time_solving_);  // ACADO
-        // solver_success = solver_.solverFunction(initial_guess_,ax_,ay_,az_,x_,y_,z_,vx_,vy_,vz_, desired_odometry_,
-        // no_fly_zone_center_,target_trajectory_,uavs_pose_);   // call the solver function  FORCES_PRO.h
-        
-        // log solved trajectory
-        logger->loggingCalculatedTrajectory(solver_success);
-
-        // if the solver didn't success, change initial guess
-        if(solver_success !=0){
-          change_initial_guess = true;
-        }else{
-          change_initial_guess = false;
-        }  
-      } while (solver_success != returnValueType::SUCCESSFUL_RETURN && solver_success != returnValueType::RET_MAX_TIME_REACHED);
-    }
-
-    // wait for the planned time
-    if(solver_timer.sleep()){
-      actual_cicle_time = 1/solver_rate_;
-    }else{
-      actual_cicle_time = round(solver_timer.cycleTime().toSec() * 10.0 )/ 10.0;
+      cycle_statistics.tick();
+      // the new plan starts from the state of the current one when it is expected to be published
+      const double now          = ros::Time::now().toSec();
+      const float  initial_time = initialTime(now + expected_solve_time_);
+
+      const std::chrono::steady_clock::time_point planning_start = std::chrono::steady_clock::now();
+      const SolverUtils::AllocationScope          allocations;
+      const FallbackLevel level = fallbackLadder(initial_time);
+      updatePlanStart(now, initial_time);
+      const double planning_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - planning_start).count();
+      planning_allocations_      = allocations.allocations();
+      if (!first_time_solving_ && planning_allocations_ > 0) {
+        ROS_WARN_ONCE("Solver %d: the planning cycle allocates (%lu allocations, %lu bytes). See planning_allocations in the metrics", drone_id_,
+                      planning_allocations_, allocations.bytes());
+      }
+      expected_solve_time_       = std::max(planning_time, SOLVE_TIME_DECAY * expected_solve_time_);
+      fallback_count_[level]++;
+      consecutive_fallbacks_ = (level == NOMINAL) ? 0 : consecutive_fallbacks_ + 1;
+      publishMetrics(level, planning_time);
+      if (cycle_statistics.cycles() > 0) {
+        publishCycleStatistics(cycle_statistics);
+      }
     }
-    // check and log the time that the last loop lasted
-    // csv_pose << "cycle time: " << actual_cicle_time << std::endl;
-    
-    // publish the last calculated trajectory if the solver successed
+    // publish the last calculated trajectory as soon as it is solved. It is stamped, so the points that have already passed are skipped
     saveCalculatedTrajectory();
-    // check if the trajectory last the planned time, if not discard the navigated points. First time does not discard points
-    if(actual_cicle_time>1/solver_rate_ && !first_time_solving_){
-      closest_point = (actual_cicle_time-1/solver_rate_)/step_size;
-    }else{
-      closest_point = 0;
-    }
     // predict yaw and pitch and publish trajectory
-    std::vector<double> yaw   = predictingYaw();
-    std::vector<double> pitch = predictingPitch();
-    publishSolvedTrajectory(yaw, pitch, closest_point);
+    SolverUtils::ArenaVector<double> yaw   = predictingYaw();
+    SolverUtils::ArenaVector<double> pitch = predictingPitch();
+    publishSolvedTrajectory(yaw, pitch);
     logger->publishPath(); // publish to visualize
+    if (cycle_arena_.overflows() > 0) {
+      ROS_WARN_ONCE("Solver %d: the cycle arena of %zu bytes is too small, the rest of the cycle is allocated in the heap", drone_id_, cycle_arena_.size());
+    }
 
     first_time_solving_=false;
-  
-    solver_timer.reset();
+
+    // wait for the next cycle
+    solver_timer.sleep();
   }
 }
\ No newline at end of file
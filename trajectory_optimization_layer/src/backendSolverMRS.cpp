@@ -21,6 +21,13 @@ backendSolverMRS::backendSolverMRS(ros::NodeHandle &_pnh, ros::NodeHandle &_nh,
   diagnostic_timer_ = _nh.createTimer(ros::Duration(diagnostic_timer_rate_), &backendSolverMRS::diagTimer, this);
   transformer_      = mrs_lib::Transformer("optimal_control_interface", "uav44");
 
+  // the tracker gets the solution resampled with the solver model, the followers keep the solver grid
+  double output_step = step_size;
+  if (ros::param::has("~output_step")) {
+    ros::param::get("~output_step", output_step);
+  }
+  resampler_ = std::make_unique<SolverUtils::TrajectoryResampler>(time_horizon, step_size, output_step);
+
   is_initialized = true;
 
   std::cout<<ANSI_COLOR_YELLOW<<"Drone "<<drone_id_<<": connecting to others and target..."<<std::endl;
@@ -33,26 +40,35 @@ backendSolverMRS::backendSolverMRS(ros::NodeHandle &_pnh, ros::NodeHandle &_nh,
 }
 
 
-void backendSolverMRS::publishSolvedTrajectory(const std::vector<double> &yaw, const std::vector<double> &pitch, const int closest_point) {
+void backendSolverMRS::publishSolvedTrajectory(const SolverUtils::ArenaVector<double> &yaw, const SolverUtils::ArenaVector<double> &pitch) {
   publishState(true);
-  mrs_msgs::Reference                   aux_point;
-  formation_church_planning::Point      aux_point_for_followers;
-  mrs_msgs::TrajectoryReference         traj_to_command;
-  formation_church_planning::Trajectory traj_to_followers;
+  typedef SolverUtils::ArenaAllocator<void>        Allocator;
+  mrs_msgs::Reference_<Allocator>                   aux_point;
+  formation_church_planning::Point_<Allocator>      aux_point_for_followers;
+  mrs_msgs::TrajectoryReference_<Allocator>         traj_to_command(cycle_arena_.allocator<void>());
+  formation_church_planning::Trajectory_<Allocator> traj_to_followers(cycle_arena_.allocator<void>());
   traj_to_command.fly_now         = true;
   traj_to_command.use_heading     = true;
-  traj_to_command.header.frame_id = trajectory_frame_;
-  traj_to_command.dt              = 0.2;
-
-  // check that _x _y _z are the same size
+  traj_to_command.header.frame_id.assign(trajectory_frame_.data(), trajectory_frame_.size());
+  traj_to_command.dt              = resampler_->outputStep();
+
+  // skip the points that have already passed, the trajectory starts at the next one
+  const ros::Time now           = ros::Time::now();
+  const int       closest_point = std::min<int>(std::max(ceil((now.toSec() - plan_start_) / step_size), 0.0), time_horizon_ - 1);
+  const ros::Time start         = ros::Time(plan_start_ + closest_point * step_size);
+  // trajectory to command
+  const int samples = resampler_->resample(&solution_[closest_point], time_horizon_ - closest_point, &yaw[closest_point], &pitch[closest_point]);
+  traj_to_command.points.reserve(samples);
+  traj_to_followers.points.reserve(time_horizon_ - closest_point);
+  for (int j = 0; j < samples; j++) {
+    aux_point.position.x = resampler_->samples()(j, SolverUtils::TrajectoryResampler::PX);
+    aux_point.position.y = resampler_->samples()(j, SolverUtils::TrajectoryResampler::PY);
+    aux_point.position.z = resampler_->samples()(j, SolverUtils::TrajectoryResampler::PZ);
+    aux_point.heading    = resampler_->samples()(j, SolverUtils::TrajectoryResampler::YAW);
+    traj_to_command.points.push_back(aux_point);
+  }
+  // trajectory to followers
   for (int i = closest_point; i < time_horizon_; i++) {
-
-    // trajectory to command
-    aux_point.position.x = solution_[i].pose.x;
-    aux_point.position.y = solution_[i].pose.y;
-    aux_point.position.z = solution_[i].pose.z;
-    aux_point.heading    = yaw[i];
-    // trajectory to followers
     aux_point_for_followers.x     = solution_[i].pose.x;
     aux_point_for_followers.y     = solution_[i].pose.y;
     aux_point_for_followers.z     = solution_[i].pose.z;
@@ -62,20 +78,20 @@ void backendSolverMRS::publishSolvedTrajectory(const std::vector<double> &yaw, c
     aux_point_for_followers.mode  = 2;
 
     traj_to_followers.points.push_back(aux_point_for_followers);
-    traj_to_command.points.push_back(aux_point);
   }
   for (size_t k = 0; k < traj_to_followers.points.size(); k++) {
-    ROS_INFO("[%s]: Traj to followers %u: [%.2f, %.2f, %.2f]", ros::this_node::getName().c_str(), drone_id_, traj_to_followers.points[k].x, traj_to_followers.points[k].y,
-             traj_to_followers.points[k].z);
+    TRACE_DEBUG(0.0, "Traj to followers %.0f: [%.2f, %.2f, %.2f]", drone_id_, traj_to_followers.points[k].x, traj_to_followers.points[k].y,
+                traj_to_followers.points[k].z);
   }
-  traj_to_command.header.stamp = ros::Time::now();
-  traj_to_followers.stamp      = ros::Time::now();
+  traj_to_command.header.stamp = start;
+  traj_to_followers.stamp      = start;
   publishTargetOdometry();
   solved_trajectory_MRS_pub.publish(traj_to_followers);
   mrs_trajectory_tracker_pub.publish(traj_to_command);
 }
 
 void backendSolverMRS::diagTimer(const ros::TimerEvent &event) {
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
   /* if (!is_initialized){ */
   /*   return; */
   /* } */
@@ -115,25 +131,27 @@ void backendSolverMRS::publishState(const bool state) {
 /** \brief uav odometry callback (mrs system)
  */
 void backendSolverMRS::uavCallback(const nav_msgs::Odometry::ConstPtr &msg) {
-  uavs_pose_[drone_id_].state.pose.x = msg->pose.pose.position.x;
-  uavs_pose_[drone_id_].state.pose.y = msg->pose.pose.position.y;
-  uavs_pose_[drone_id_].state.pose.z = msg->pose.pose.position.z;
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
+  received_.uavs_pose[drone_id_].state.pose.x = msg->pose.pose.position.x;
+  received_.uavs_pose[drone_id_].state.pose.y = msg->pose.pose.position.y;
+  received_.uavs_pose[drone_id_].state.pose.z = msg->pose.pose.position.z;
 
-  uavs_pose_[drone_id_].state.quaternion.x = msg->pose.pose.orientation.x;
-  uavs_pose_[drone_id_].state.quaternion.y = msg->pose.pose.orientation.y;
-  uavs_pose_[drone_id_].state.quaternion.z = msg->pose.pose.orientation.z;
-  uavs_pose_[drone_id_].state.quaternion.w = msg->pose.pose.orientation.w;
+  received_.uavs_pose[drone_id_].state.quaternion.x = msg->pose.pose.orientation.x;
+  received_.uavs_pose[drone_id_].state.quaternion.y = msg->pose.pose.orientation.y;
+  received_.uavs_pose[drone_id_].state.quaternion.z = msg->pose.pose.orientation.z;
+  received_.uavs_pose[drone_id_].state.quaternion.w = msg->pose.pose.orientation.w;
 
-  uavs_pose_[drone_id_].state.velocity.x = msg->twist.twist.linear.x;
-  uavs_pose_[drone_id_].state.velocity.y = msg->twist.twist.linear.y;
-  uavs_pose_[drone_id_].state.velocity.z = msg->twist.twist.linear.z;
+  received_.uavs_pose[drone_id_].state.velocity.x = msg->twist.twist.linear.x;
+  received_.uavs_pose[drone_id_].state.velocity.y = msg->twist.twist.linear.y;
+  received_.uavs_pose[drone_id_].state.velocity.z = msg->twist.twist.linear.z;
 
-  uavs_pose_[drone_id_].has_pose = true;
+  received_.uavs_pose[drone_id_].has_pose = true;
 }
 
 
 
 void backendSolverMRS::targetCallbackMRS(const nav_msgs::Odometry::ConstPtr &_msg) {
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
   transformer_.setCurrentControlFrame(trajectory_frame_);
   geometry_msgs::PoseStamped pose_tmp;
   pose_tmp.header = _msg->header;
@@ -151,20 +169,20 @@ void backendSolverMRS::targetCallbackMRS(const nav_msgs::Odometry::ConstPtr &_ms
   auto response_vel   = transformer_.transformSingle(trajectory_frame_, global_vel);
   if (response_pose && response_vel) {
     ROS_INFO_THROTTLE(1.0, "[%s]: Target odometry succesfully transformed", ros::this_node::getName().c_str());
-    target_odometry_.pose.pose            = response_pose.value().pose;
-    target_odometry_.twist.twist.linear.x = response_vel.value().vector.x;
-    target_odometry_.twist.twist.linear.y = response_vel.value().vector.y;
-    target_odometry_.twist.twist.linear.z = response_vel.value().vector.z;
-    target_has_pose                     = true;
+    received_.target_odometry.pose.pose            = response_pose.value().pose;
+    received_.target_odometry.twist.twist.linear.x = response_vel.value().vector.x;
+    received_.target_odometry.twist.twist.linear.y = response_vel.value().vector.y;
+    received_.target_odometry.twist.twist.linear.z = response_vel.value().vector.z;
+    received_.target_has_pose                      = true;
   }
   /* target_odometry_ = *_msg; */
 }
 
 void backendSolverMRS::publishTargetOdometry() {
-  if (!target_has_pose) {
+  if (!received_.target_has_pose) {
     return;
   }
-  nav_msgs::Odometry msg = target_odometry_;
+  nav_msgs::Odometry msg = received_.target_odometry;
   msg.header.frame_id    = "uav47/gps_origin";
   try {
     target_odometry_pub.publish(msg);
@@ -175,6 +193,7 @@ void backendSolverMRS::publishTargetOdometry() {
 }
 
 bool backendSolverMRS::activationServiceCallback(std_srvs::SetBool::Request &req, std_srvs::SetBool::Response &res) {
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
   ROS_INFO("[%s]: Activation service called.", ros::this_node::getName().c_str());
   if (first_activation_) {
     ROS_INFO("[%s]: Initial pose set.", ros::this_node::getName().c_str());
@@ -16,39 +16,46 @@ backendSolverUAL::backendSolverUAL(ros::NodeHandle &_pnh, ros::NodeHandle &_nh,
 }
 
 void backendSolverUAL::ownVelocityCallback(const geometry_msgs::TwistStamped::ConstPtr &msg) {
-
-  uavs_pose_[drone_id_].state.velocity.x = msg->twist.linear.x;
-  uavs_pose_[drone_id_].state.velocity.y = msg->twist.linear.y;
-  uavs_pose_[drone_id_].state.velocity.z = msg->twist.linear.z;
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
+  received_.uavs_pose[drone_id_].state.velocity.x = msg->twist.linear.x;
+  received_.uavs_pose[drone_id_].state.velocity.y = msg->twist.linear.y;
+  received_.uavs_pose[drone_id_].state.velocity.z = msg->twist.linear.z;
 }
 
 /** \brief Callback for the target pose
  */
 void backendSolverUAL::targetPoseCallbackGRVC(const nav_msgs::Odometry::ConstPtr &msg) {
-  target_has_pose          = true;
-  target_odometry_ = *msg;
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
+  received_.target_has_pose = true;
+  received_.target_odometry = *msg;
 }
 
 void backendSolverUAL::uavPoseCallback(const geometry_msgs::PoseStamped::ConstPtr &msg){
-  uavs_pose_[drone_id_].has_pose = true;
-  uavs_pose_[drone_id_].state.pose.x = msg->pose.position.x;
-  uavs_pose_[drone_id_].state.pose.y = msg->pose.position.y;
-  uavs_pose_[drone_id_].state.pose.z = msg->pose.position.z;
-
-  uavs_pose_[drone_id_].state.quaternion.x = msg->pose.orientation.x;
-  uavs_pose_[drone_id_].state.quaternion.y = msg->pose.orientation.y;
-  uavs_pose_[drone_id_].state.quaternion.z = msg->pose.orientation.z;
-  uavs_pose_[drone_id_].state.quaternion.w = msg->pose.orientation.w; 
+  std::lock_guard<std::mutex> lock(inputs_mutex_);
+  received_.uavs_pose[drone_id_].has_pose = true;
+  received_.uavs_pose[drone_id_].state.pose.x = msg->pose.position.x;
+  received_.uavs_pose[drone_id_].state.pose.y = msg->pose.position.y;
+  received_.uavs_pose[drone_id_].state.pose.z = msg->pose.position.z;
+
+  received_.uavs_pose[drone_id_].state.quaternion.x = msg->pose.orientation.x;
+  received_.uavs_pose[drone_id_].state.quaternion.y = msg->pose.orientation.y;
+  received_.uavs_pose[drone_id_].state.quaternion.z = msg->pose.orientation.z;
+  received_.uavs_pose[drone_id_].state.quaternion.w = msg->pose.orientation.w; 
 }
 
-void backendSolverUAL::publishSolvedTrajectory(const std::vector<double> &yaw, const std::vector<double> &pitch, const int delayed_points /*0 default */) {
+void backendSolverUAL::publishSolvedTrajectory(const SolverUtils::ArenaVector<double> &yaw, const SolverUtils::ArenaVector<double> &pitch) {
 
-  optimal_control_interface::Solver traj;
-  geometry_msgs::PoseStamped        pos;
-  geometry_msgs::Twist              vel;
+  typedef SolverUtils::ArenaAllocator<void> Allocator;
+  optimal_control_interface::Solver_<Allocator> traj(cycle_arena_.allocator<void>());
+  geometry_msgs::PoseStamped_<Allocator>        pos;
+  geometry_msgs::Twist_<Allocator>              vel;
 
+  traj.header.stamp = ros::Time(plan_start_);
+  traj.positions.reserve(time_horizon_);
+  traj.velocities.reserve(time_horizon_);
   for (int i = 0; i < time_horizon_; i++) {
     // trajectory to visualize
+    pos.header.stamp    = ros::Time(plan_start_ + i * step_size);
     pos.pose.position.x = solution_[i].pose.x;
     pos.pose.position.y = solution_[i].pose.y;
     pos.pose.position.z = solution_[i].pose.z;
@@ -0,0 +1,297 @@
+#include <batch_planner.h>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+
+bool BatchPlanning::readMission(const std::string &path, Mission &mission) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    std::cout << ANSI_COLOR_RED << "error opening mission file " << path << ANSI_COLOR_RESET << std::endl;
+    return false;
+  }
+  const std::map<std::string, int> shot_types = {{"GOTO", shot_executer::ShootingAction::Request::GOTO},
+                                                 {"FOLLOW", shot_executer::ShootingAction::Request::FOLLOW},
+                                                 {"FLYOVER", shot_executer::ShootingAction::Request::FLYOVER},
+                                                 {"ESTABLISH", shot_executer::ShootingAction::Request::ESTABLISH},
+                                                 {"ELEVATOR", shot_executer::ShootingAction::Request::ELEVATOR}};
+  std::string line;
+  int         line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    line = line.substr(0, line.find('#'));
+    std::stringstream ss(line);
+    std::string       key;
+    if (!(ss >> key)) {  // empty line or comment
+      continue;
+    }
+    bool valid = false;
+    if (key == "uav") {
+      valid = static_cast<bool>(ss >> mission.uav_initial_position.x() >> mission.uav_initial_position.y() >> mission.uav_initial_position.z());
+    } else if (key == "target") {
+      double          t;
+      Eigen::Vector3d position;
+      valid = static_cast<bool>(ss >> t >> position.x() >> position.y() >> position.z());
+      valid = valid && (mission.target_waypoints.empty() || t > mission.target_waypoints.back().first);
+      if (valid) {
+        mission.target_waypoints.push_back(std::make_pair(t, position));
+      }
+    } else if (key == "no_fly_zone") {
+      float x, y;
+      valid = static_cast<bool>(ss >> x >> y);
+      if (valid) {
+        mission.no_fly_zone = {x, y};
+      }
+    } else if (key == "shot") {
+      std::string type;
+      MissionShot shot;
+      valid = static_cast<bool>(ss >> type >> shot.duration >> shot.action.rt_parameters.x >> shot.action.rt_parameters.y >> shot.action.rt_parameters.z);
+      valid = valid && shot_types.count(type) && shot.duration > 0.0;
+      if (valid) {
+        shot.action.shooting_action_type = shot_types.at(type);
+        shot.action.duration             = shot.duration;
+        shot.action.target_type          = 1;
+        mission.shots.push_back(shot);
+      }
+    }
+    if (!valid) {
+      std::cout << ANSI_COLOR_RED << path << ":" << line_number << ": invalid line '" << line << "'" << ANSI_COLOR_RESET << std::endl;
+      return false;
+    }
+  }
+  if (mission.target_waypoints.empty()) {  // static target at the origin
+    mission.target_waypoints.push_back(std::make_pair(0.0, Eigen::Vector3d::Zero()));
+  }
+  return true;
+}
+
+nav_msgs::Odometry BatchPlanning::targetOdometry(const Mission &mission, const double t) {
+  const std::vector<std::pair<double, Eigen::Vector3d>> &waypoints = mission.target_waypoints;
+  Eigen::Vector3d                                        position  = waypoints.back().second;
+  Eigen::Vector3d                                        velocity  = Eigen::Vector3d::Zero();
+  if (t <= waypoints.front().first) {
+    position = waypoints.front().second;
+  } else {
+    for (size_t i = 1; i < waypoints.size(); i++) {
+      if (t < waypoints[i].first) {
+        velocity = (waypoints[i].second - waypoints[i - 1].second) / (waypoints[i].first - waypoints[i - 1].first);
+        position = waypoints[i - 1].second + velocity * (t - waypoints[i - 1].first);
+        break;
+      }
+    }
+  }
+  nav_msgs::Odometry odometry;
+  odometry.pose.pose.position.x    = position.x();
+  odometry.pose.pose.position.y    = position.y();
+  odometry.pose.pose.position.z    = position.z();
+  odometry.pose.pose.orientation.w = 1.0;
+  odometry.twist.twist.linear.x    = velocity.x();
+  odometry.twist.twist.linear.y    = velocity.y();
+  odometry.twist.twist.linear.z    = velocity.z();
+  return odometry;
+}
+
+/** \brief known target trajectory along the horizon. Offline, the shot is evaluated over the real target path instead of a velocity constant prediction
+ */
+static std::vector<nav_msgs::Odometry> targetTrajectory(const BatchPlanning::Mission &mission, const double t, const int time_horizon, const float step_size) {
+  std::vector<nav_msgs::Odometry> target_trajectory;
+  for (int i = 0; i < time_horizon; i++) {
+    target_trajectory.push_back(BatchPlanning::targetOdometry(mission, t + i * step_size));
+  }
+  return target_trajectory;
+}
+
+/** \brief state of the target at time t as the shot executer sees it. The path is known, so the target yaw is taken from any velocity.
+ *         The drone pose is the pose at the start of the shot (ELEVATOR keeps its x and y)
+ */
+static ShotExecuter::target_snapshot targetSnapshot(const BatchPlanning::Mission &mission, const double t, const Eigen::Vector3d &drone_position) {
+  ShotExecuter::target_snapshot snapshot;
+  snapshot.target_pose                     = BatchPlanning::targetOdometry(mission, t);
+  snapshot.drone_pose.pose.pose.position.x = drone_position.x();
+  snapshot.drone_pose.pose.pose.position.y = drone_position.y();
+  snapshot.drone_pose.pose.pose.position.z = drone_position.z();
+  const double target_vx                   = snapshot.target_pose.twist.twist.linear.x;
+  const double target_vy                   = snapshot.target_pose.twist.twist.linear.y;
+  if (sqrt(pow(target_vx, 2) + pow(target_vy, 2)) > 0.0) {
+    snapshot.target_yaw = atan2(target_vy, target_vx);
+  }
+  return snapshot;
+}
+
+BatchPlanning::BatchPlanner::BatchPlanner(const Mission &mission, const int time_horizon, const float solver_rate)
+    : mission_(mission), time_horizon_(time_horizon), solver_rate_(solver_rate) {
+}
+
+BatchPlanning::SegmentResult BatchPlanning::BatchPlanner::planSegment(const int shot, const double start_time, const Eigen::Vector3d &start, const bool last) const {
+  SegmentResult              result;
+  Simulation::PlannerHarness planner(time_horizon_, solver_rate_);
+  planner.setNoFlyZone(mission_.no_fly_zone);
+  planner.setUavState(start, Eigen::Vector3d::Zero());
+
+  const int          steps_per_cycle = round(1.0 / (solver_rate_ * step_size_));
+  const int          cycles          = std::max(1, (int)ceil(mission_.shots[shot].duration * solver_rate_));
+  std::vector<State> solution;
+  for (int cycle = 0; cycle < cycles; cycle++) {
+    const double t = start_time + cycle / solver_rate_;
+    // shot evaluated over the known target path
+    const ShotExecuter::target_snapshot snapshot = targetSnapshot(mission_, t, start);
+    const shot_executer::DesiredShot    desired_shot =
+        ShotExecuter::calculateDesiredPoint(mission_.shots[shot].action, targetTrajectory(mission_, t, time_horizon_, step_size_), snapshot);
+    planner.setTarget(snapshot.target_pose);
+    planner.setDesiredShot(desired_shot);
+
+    // same cycle again if the solver fails, as the online node does
+    int status;
+    int tries = 0;
+    do {
+      status = planner.plan(t);
+      result.solver_calls++;
+      tries++;
+      if (!Simulation::PlannerHarness::solverSucceeded(status)) {
+        result.solver_failures++;
+      }
+    } while (!Simulation::PlannerHarness::solverSucceeded(status) && tries < max_retries_);
+    if (!Simulation::PlannerHarness::solverSucceeded(status)) {
+      return result;
+    }
+
+    // the uav follows the solution from the current time until the next cycle. The first points are the ones spliced from the previous solution
+    solution              = planner.getSolution();
+    const int first_point = std::min<int>(std::max(round((t - planner.getSolutionStart()) / step_size_), 0.0), time_horizon_ - 1);
+    const int keep_steps  = (last && cycle == cycles - 1) ? time_horizon_ - first_point : std::min(steps_per_cycle, time_horizon_ - 1 - first_point);
+    result.states.insert(result.states.end(), solution.begin() + first_point, solution.begin() + first_point + keep_steps);
+    result.end = solution[std::min(first_point + keep_steps, time_horizon_ - 1)];
+  }
+  result.success = true;
+  return result;
+}
+
+Eigen::Vector3d BatchPlanning::BatchPlanner::shotEndPosition(const int shot, const double end_time, const Eigen::Vector3d &start) const {
+  const shot_executer::DesiredShot desired_shot =
+      ShotExecuter::calculateDesiredPoint(mission_.shots[shot].action, targetTrajectory(mission_, end_time, 1, step_size_), targetSnapshot(mission_, end_time, start));
+  return Eigen::Vector3d(desired_shot.desired_odometry.pose.pose.position.x, desired_shot.desired_odometry.pose.pose.position.y,
+                         desired_shot.desired_odometry.pose.pose.position.z);
+}
+
+std::vector<BatchPlanning::SegmentResult> BatchPlanning::BatchPlanner::planSegmentsInParallel(const std::vector<double>          &start_times,
+                                                                                              const std::vector<Eigen::Vector3d> &starts, const int jobs) const {
+  const int                  segments = start_times.size();
+  std::vector<SegmentResult> results(segments);
+  std::vector<FILE *>        files(segments, nullptr);  // each child writes its segment in a temporary file
+  std::map<pid_t, int>       running;
+  int                        next = 0;
+
+  std::cout << std::flush;
+  while (next < segments || !running.empty()) {
+    if (next < segments && (int)running.size() < std::max(1, jobs)) {
+      files[next] = tmpfile();
+      const pid_t pid = files[next] ? fork() : -1;
+      if (pid == 0) {  // child
+        const SegmentResult result = planSegment(next, start_times[next], starts[next], next == segments - 1);
+        const int           header[3] = {result.success, result.solver_calls, result.solver_failures};
+        const size_t        size      = result.states.size();
+        fwrite(header, sizeof(header), 1, files[next]);
+        fwrite(&result.end, sizeof(State), 1, files[next]);
+        fwrite(&size, sizeof(size), 1, files[next]);
+        fwrite(result.states.data(), sizeof(State), size, files[next]);
+        fflush(files[next]);
+        _exit(0);
+      } else if (pid > 0) {
+        running[pid] = next;
+      } else {  // no process available, solve it here
+        results[next] = planSegment(next, start_times[next], starts[next], next == segments - 1);
+      }
+      next++;
+      continue;
+    }
+    int         child_status;
+    const pid_t pid = wait(&child_status);
+    if (pid < 0) {
+      break;
+    }
+    const int segment = running[pid];
+    running.erase(pid);
+    int    header[3] = {0, 0, 0};
+    size_t size      = 0;
+    rewind(files[segment]);
+    if (WIFEXITED(child_status) && WEXITSTATUS(child_status) == 0 && fread(header, sizeof(header), 1, files[segment]) == 1 &&
+        fread(&results[segment].end, sizeof(State), 1, files[segment]) == 1 && fread(&size, sizeof(size), 1, files[segment]) == 1) {
+      results[segment].states.resize(size);
+      results[segment].success         = header[0] && fread(results[segment].states.data(), sizeof(State), size, files[segment]) == size;
+      results[segment].solver_calls    = header[1];
+      results[segment].solver_failures = header[2];
+    }
+    fclose(files[segment]);
+    files[segment] = nullptr;
+  }
+  for (FILE *file : files) {
+    if (file) {
+      fclose(file);
+    }
+  }
+  return results;
+}
+
+bool BatchPlanning::BatchPlanner::plan(const int jobs) {
+  trajectory_.clear();
+  if (mission_.shots.empty()) {
+    std::cout << ANSI_COLOR_RED << "the mission has no shots" << ANSI_COLOR_RESET << std::endl;
+    return false;
+  }
+  // each segment starts where the previous shot should leave the uav
+  const int                    segments = mission_.shots.size();
+  std::vector<double>          start_times(segments, 0.0);
+  std::vector<Eigen::Vector3d> starts(segments, mission_.uav_initial_position);
+  for (int i = 1; i < segments; i++) {
+    start_times[i] = start_times[i - 1] + mission_.shots[i - 1].duration;
+    starts[i]      = shotEndPosition(i - 1, start_times[i], starts[i - 1]);
+  }
+  std::vector<SegmentResult> results = planSegmentsInParallel(start_times, starts, jobs);
+
+  // stitch the segments. Solve again the ones that don't start where the previous one ends
+  int solver_calls    = 0;
+  int solver_failures = 0;
+  int replanned       = 0;
+  for (int i = 0; i < segments; i++) {
+    if (i > 0) {
+      const Eigen::Vector3d end(results[i - 1].end.pose.x, results[i - 1].end.pose.y, results[i - 1].end.pose.z);
+      if (!results[i].success || (end - starts[i]).norm() > stitch_tolerance_) {
+        solver_calls += results[i].solver_calls;
+        solver_failures += results[i].solver_failures;
+        starts[i]  = end;
+        results[i] = planSegment(i, start_times[i], end, i == segments - 1);
+        replanned++;
+      }
+    }
+    solver_calls += results[i].solver_calls;
+    solver_failures += results[i].solver_failures;
+    if (!results[i].success) {
+      std::cout << ANSI_COLOR_RED << "shot " << i << " could not be planned" << ANSI_COLOR_RESET << std::endl;
+      return false;
+    }
+    trajectory_.insert(trajectory_.end(), results[i].states.begin(), results[i].states.end());
+  }
+  std::cout << "planned " << segments << " shots (" << replanned << " planned again to stitch them), " << trajectory_.size() << " points, solver failures "
+            << solver_failures << "/" << solver_calls << std::endl;
+  return true;
+}
+
+bool BatchPlanning::BatchPlanner::writeFollowerFiles(const std::string &path) const {
+  std::ofstream positions(path + "_positions.csv");
+  std::ofstream velocities(path + "_vels.csv");
+  if (!positions.is_open() || !velocities.is_open()) {
+    std::cout << ANSI_COLOR_RED << "error opening " << path << "_positions.csv or " << path << "_vels.csv" << ANSI_COLOR_RESET << std::endl;
+    return false;
+  }
+  positions << std::fixed << std::setprecision(5);
+  velocities << std::fixed << std::setprecision(5);
+  for (size_t i = 0; i < trajectory_.size(); i++) {
+    // the follower reads until the end of the file, so there is no new line after the last point
+    const char *end_of_line = i + 1 < trajectory_.size() ? "\n" : "";
+    positions << trajectory_[i].pose.x << ", " << trajectory_[i].pose.y << ", " << trajectory_[i].pose.z << end_of_line;
+    velocities << trajectory_[i].velocity.x << ", " << trajectory_[i].velocity.y << ", " << trajectory_[i].velocity.z << end_of_line;
+  }
+  return positions.good() && velocities.good();
+}
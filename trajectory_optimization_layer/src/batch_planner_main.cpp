@@ -0,0 +1,30 @@
+#include <batch_planner.h>
+#include <thread>
+
+/** Batch offline planning of a mission for the trajectory follower
+ *  Usage: batch_planner <mission_file> <output_path> [jobs] [solver_rate]
+ *  Writes <output_path>_positions.csv and <output_path>_vels.csv. Set the follower's path_csv param to output_path and call start_shooting
+ */
+int main(int _argc, char **_argv) {
+  if (_argc < 3) {
+    std::cout << "usage: batch_planner <mission_file> <output_path> [jobs] [solver_rate]" << std::endl;
+    return 1;
+  }
+  const int   jobs        = _argc > 3 ? std::stoi(_argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+  const float solver_rate = _argc > 4 ? std::stof(_argv[4]) : 1.0;
+
+  BatchPlanning::Mission mission;
+  if (!BatchPlanning::readMission(_argv[1], mission)) {
+    return 1;
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  BatchPlanning::BatchPlanner           planner(mission, 40, solver_rate);
+  if (!planner.plan(jobs) || !planner.writeFollowerFiles(_argv[2])) {
+    return 1;
+  }
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "mission of " << planner.trajectory().size() * 0.2 << " s planned in " << elapsed << " s, written to " << _argv[2] << "_positions.csv and "
+            << _argv[2] << "_vels.csv" << std::endl;
+  return 0;
+}
@@ -0,0 +1,228 @@
+#include <condensed_qp_solver.h>
+#include <limits>
+
+NumericalSolver::CondensedQPSolver::CondensedQPSolver(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess) : Solver(solving_rate, time_horizon, initial_guess){
+    condensed(time_horizon_);
+}
+
+NumericalSolver::CondensedQPSolver::Problem &NumericalSolver::CondensedQPSolver::condensed(const int N){
+    std::unique_ptr<Problem> &cached = problems_[N];
+    if(cached){
+        return *cached;
+    }
+    cached = std::make_unique<Problem>();
+    Problem &problem = *cached;
+    const double h = step_size;
+    problem.n_acc = N-2;
+    problem.n = 3+3*(N-2)+N;
+
+    // v_k = v0 + h*a0 + h*sum(a_j, 0<j<k),  p_k = p0 + k*h*v0 + h^2*(k-0.5)*a0 + h^2*sum((k-j-0.5)*a_j, 0<j<k)
+    for(int axis=0; axis<3; axis++){
+        problem.position[axis] = Eigen::MatrixXd::Zero(N, problem.n);
+        problem.velocity[axis] = Eigen::MatrixXd::Zero(N, problem.n);
+        for(int k=0; k<N; k++){
+            problem.position[axis](k, problem.velocityIndex(axis)) = k*h;
+            problem.velocity[axis](k, problem.velocityIndex(axis)) = 1.0;
+            for(int j=1; j<k && j<=problem.n_acc; j++){
+                problem.position[axis](k, problem.accIndex(axis,j)) = h*h*(k-j-0.5);
+                problem.velocity[axis](k, problem.accIndex(axis,j)) = h;
+            }
+        }
+    }
+
+    const double w_acc[3] = {W_AX, W_AY, W_AZ};
+    const double w_end[2] = {W_PX_N, W_PY_N};
+    const double w_reference[3] = {W_PX, W_PY, W_PZ};
+    problem.hessian_fixed = Eigen::MatrixXd::Zero(problem.n, problem.n);
+    problem.hessian_reference = Eigen::MatrixXd::Zero(problem.n, problem.n);
+    for(int axis=0; axis<3; axis++){
+        for(int k=1; k<=problem.n_acc; k++){
+            problem.hessian_fixed(problem.accIndex(axis,k), problem.accIndex(axis,k)) = 2*w_acc[axis];
+        }
+        if(axis < 2){  // the end term of the ACADO problem is only on x and y
+            problem.hessian_fixed += 2*w_end[axis]*problem.position[axis].row(N-1).transpose()*problem.position[axis].row(N-1);
+        }
+        problem.hessian_reference += 2*w_reference[axis]*problem.position[axis].transpose()*problem.position[axis];
+    }
+    for(int k=0; k<N; k++){
+        problem.hessian_fixed(problem.slackIndex(k), problem.slackIndex(k)) = 2*W_SLACK;
+    }
+
+    // constraints: accelerations, velocities (including v0), height over the target with slack, positive slack
+    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(3*problem.n_acc+3*N+2*N, problem.n);
+    int row = 0;
+    for(int axis=0; axis<3; axis++){
+        for(int k=1; k<=problem.n_acc; k++){
+            A(row++, problem.accIndex(axis,k)) = 1.0;
+        }
+    }
+    for(int axis=0; axis<3; axis++){
+        A.block(row, 0, N, problem.n) = problem.velocity[axis];
+        row += N;
+    }
+    A.block(row, 0, N, problem.n) = problem.position[2];
+    for(int k=0; k<N; k++){
+        A(row+k, problem.slackIndex(k)) = 1.0;
+    }
+    row += N;
+    for(int k=0; k<N; k++){
+        A(row++, problem.slackIndex(k)) = 1.0;
+    }
+
+    problem.qp = std::make_unique<DenseQP>(problem.hessian_fixed, A);
+    return problem;
+}
+
+int NumericalSolver::CondensedQPSolver::solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position, bool first_time_solving, int _drone_id, bool _target /*false*/,bool _multi/*false*/){
+    const int N = solvedHorizon();
+    const double h = step_size;
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    const State start = initialState(_uavs_pose, time_initial_position, first_time_solving, _drone_id);
+    const double p0[3] = {start.pose.x, start.pose.y, start.pose.z};
+    const double v0[3] = {start.velocity.x, start.velocity.y, start.velocity.z};
+    const double a0[3] = {first_time_solving ? 0.0 : start.acc.x, first_time_solving ? 0.0 : start.acc.y, first_time_solving ? 0.0 : start.acc.z};
+    const double max_vel[3] = {MAX_VEL_XY, MAX_VEL_XY, MAX_VEL_Z};
+    const double w_end[2] = {W_PX_N, W_PY_N};
+    const double desired[2] = {_desired_odometry.pose.pose.position.x, _desired_odometry.pose.pose.position.y};
+    const double w_reference[3] = {W_PX, W_PY, W_PZ};
+    Problem &problem = condensed(N);
+
+    // part of the states fixed by the initial state
+    Eigen::VectorXd position_fixed[3], velocity_fixed[3];
+    for(int axis=0; axis<3; axis++){
+        position_fixed[axis] = Eigen::VectorXd::Constant(N, p0[axis]);
+        velocity_fixed[axis] = Eigen::VectorXd::Zero(N);
+        for(int k=1; k<N; k++){
+            position_fixed[axis](k) += h*h*(k-0.5)*a0[axis];
+            velocity_fixed[axis](k) = h*a0[axis];
+        }
+    }
+
+    // linear cost of the quadratic terms
+    Eigen::VectorXd q_fixed = Eigen::VectorXd::Zero(problem.n);
+    for(int axis=0; axis<2; axis++){
+        q_fixed += 2*w_end[axis]*(position_fixed[axis](N-1)-desired[axis])*problem.position[axis].row(N-1).transpose();
+    }
+    Eigen::MatrixXd hessian_fixed = problem.hessian_fixed;
+    if(!_reference_trajectory.empty()){
+        hessian_fixed += problem.hessian_reference;
+        for(int axis=0; axis<3; axis++){
+            Eigen::VectorXd reference(N);
+            for(int k=0; k<N; k++){
+                // hold the last reference point if the reference is shorter than the horizon
+                const geometry_msgs::Point &point = _reference_trajectory[std::min<size_t>(k,_reference_trajectory.size()-1)].pose.pose.position;
+                reference(k) = axis == 0 ? point.x : (axis == 1 ? point.y : point.z);
+            }
+            q_fixed += 2*w_reference[axis]*problem.position[axis].transpose()*(position_fixed[axis]-reference);
+        }
+    }
+
+    // bounds
+    Eigen::VectorXd l(3*problem.n_acc+5*N), u(3*problem.n_acc+5*N);
+    int row = 0;
+    l.segment(row, 3*problem.n_acc).setConstant(-MAX_ACC);
+    u.segment(row, 3*problem.n_acc).setConstant(MAX_ACC);
+    row += 3*problem.n_acc;
+    for(int axis=0; axis<3; axis++){
+        l.segment(row, N) = -max_vel[axis]-velocity_fixed[axis].array();
+        u.segment(row, N) = max_vel[axis]-velocity_fixed[axis].array();
+        if(!first_time_solving){
+            l(row) = u(row) = v0[axis];
+        }
+        row += N;
+    }
+    for(int k=0; k<N; k++){
+        // hold the last target point if the target trajectory is shorter than the horizon, as the pitch term
+        const double target_z = _target_trajectory.empty() ? -infinity : _target_trajectory[std::min<size_t>(k,_target_trajectory.size()-1)].pose.pose.position.z;
+        l(row+k) = Z_RELATIVE_TARGET_DRONE+target_z-position_fixed[2](k);
+        u(row+k) = infinity;
+    }
+    row += N;
+    l.segment(row, N).setZero();
+    u.segment(row, N).setConstant(infinity);
+
+    // trajectory to linearize the pitch term: the initial guess, and then the last QP solution
+    Eigen::MatrixXd trajectory(N, 3);
+    for(int k=0; k<N; k++){
+        trajectory.row(k) << initial_guess_[k].pose.x, initial_guess_[k].pose.y, initial_guess_[k].pose.z;
+    }
+    // the pitch is measured to the target at every step
+    Eigen::MatrixXd target(N, 3);
+    for(int k=0; k<N && !_target_trajectory.empty(); k++){
+        const geometry_msgs::Point &point = _target_trajectory[std::min<size_t>(k,_target_trajectory.size()-1)].pose.pose.position;
+        target.row(k) << point.x, point.y, point.z;
+    }
+
+    // the QP tolerance follows the options. The SQP stops when its time budget is spent, keeping the last QP solution
+    problem.qp->tolerance_ = QP_TOLERANCE*options_.tolerance_scale;
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    solver_success_ = QP_NOT_CONVERGED;
+    qp_iterations_ = 0;
+    Eigen::MatrixXd pitch_jacobian(N, problem.n);
+    Eigen::VectorXd pitch_residual(N);
+    for(int iteration=0; iteration<max_sqp_iterations_; iteration++){
+        Eigen::MatrixXd hessian = hessian_fixed;
+        Eigen::VectorXd q = q_fixed;
+        if(!_target_trajectory.empty()){
+            // Gauss-Newton: r_k(p) ~ r_k(p_bar) + grad_k'(p - p_bar), weighted with the step size as the Lagrange term
+            for(int k=0; k<N; k++){
+                Eigen::Vector3d gradient;
+                const Eigen::Vector3d p_bar = trajectory.row(k).transpose();
+                pitch_residual(k) = pitchResidual(p_bar, target.row(k).transpose(), gradient);
+                pitch_jacobian.row(k).setZero();
+                for(int axis=0; axis<3; axis++){
+                    pitch_jacobian.row(k) += gradient(axis)*problem.position[axis].row(k);
+                    pitch_residual(k) += gradient(axis)*(position_fixed[axis](k)-p_bar(axis));
+                }
+            }
+            hessian += 2*h*pitch_jacobian.transpose()*pitch_jacobian;
+            q += 2*h*pitch_jacobian.transpose()*pitch_residual;
+        }
+        problem.qp->setHessian(hessian);
+        const int qp_iterations = problem.qp->solve(q, l, u, problem.x);
+        if(qp_iterations < 0){
+            solver_success_ = QP_NOT_CONVERGED;
+            break;
+        }
+        qp_iterations_ += qp_iterations;
+        solver_success_ = returnValueType::SUCCESSFUL_RETURN;
+
+        Eigen::MatrixXd new_trajectory(N, 3);
+        for(int axis=0; axis<3; axis++){
+            new_trajectory.col(axis) = problem.position[axis]*problem.x+position_fixed[axis];
+        }
+        const double change = (new_trajectory-trajectory).lpNorm<Eigen::Infinity>();
+        trajectory = new_trajectory;
+        if(change < sqp_tolerance_*options_.tolerance_scale || std::chrono::duration<double>(std::chrono::steady_clock::now()-start_time).count() > options_.max_time){
+            break;
+        }
+    }
+    if(solver_success_ != returnValueType::SUCCESSFUL_RETURN){
+        return solver_success_;
+    }
+
+    std::vector<State> grid_solution(time_horizon_);
+    for(int k=0; k<N; k++){
+        const Eigen::Vector3d velocity(problem.velocity[0].row(k)*problem.x+velocity_fixed[0](k), problem.velocity[1].row(k)*problem.x+velocity_fixed[1](k), problem.velocity[2].row(k)*problem.x+velocity_fixed[2](k));
+        double acc[3];
+        for(int axis=0; axis<3; axis++){
+            // the QP solution is clipped to the tolerance of the solver
+            acc[axis] = k == 0 ? a0[axis] : (k <= problem.n_acc ? std::min<double>(std::max<double>(problem.x(problem.accIndex(axis,k)), -MAX_ACC), MAX_ACC) : 0.0);
+        }
+        grid_solution[k].pose.x = trajectory(k,0);
+        grid_solution[k].pose.y = trajectory(k,1);
+        grid_solution[k].pose.z = trajectory(k,2);
+        grid_solution[k].velocity.x = velocity(0);
+        grid_solution[k].velocity.y = velocity(1);
+        grid_solution[k].velocity.z = velocity(2);
+        grid_solution[k].acc.x = acc[0];
+        grid_solution[k].acc.y = acc[1];
+        grid_solution[k].acc.z = acc[2];
+    }
+    // the rest of the horizon brakes, as in the ACADO solver
+    brake(grid_solution.data(), N-1, time_horizon_, step_size, MAX_ACC);
+    setSolution(grid_solution.data(), time_initial_position, first_time_solving);
+    return solver_success_;
+}
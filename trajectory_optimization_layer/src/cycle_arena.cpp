@@ -0,0 +1,16 @@
+#include <cycle_arena.h>
+
+SolverUtils::CycleArena::CycleArena(const size_t size) : buffer_(size), arena_(buffer_.data(), buffer_.size(), &upstream_) {}
+
+void SolverUtils::CycleArena::reset() {
+  arena_.release();
+}
+
+void *SolverUtils::CycleArena::Upstream::do_allocate(size_t bytes, size_t alignment) {
+  allocations++;
+  return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void SolverUtils::CycleArena::Upstream::do_deallocate(void *pointer, size_t bytes, size_t alignment) {
+  std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+}
@@ -0,0 +1,63 @@
+#include <decoupled_solver.h>
+
+NumericalSolver::DecoupledSolver::DecoupledSolver(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess) : Solver(solving_rate, time_horizon, initial_guess){
+    for(int axis=0; axis<3; axis++){
+        AxisParameters parameters;
+        parameters.time_horizon = time_horizon_;
+        parameters.step_size    = step_size;
+        parameters.max_vel      = axis < 2 ? MAX_VEL_XY : MAX_VEL_Z;
+        parameters.max_acc      = MAX_ACC;
+        parameters.w_acc        = axis == 0 ? W_AX : (axis == 1 ? W_AY : W_AZ);
+        parameters.w_end        = axis == 0 ? W_PX_N : (axis == 1 ? W_PY_N : 0.0);  // the end term of the ACADO problem is only on x and y
+        axes_[axis] = std::make_unique<AxisMPC>(parameters);
+    }
+    grid_solution_.resize(time_horizon_);
+}
+
+bool NumericalSolver::DecoupledSolver::isDecoupled(const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, const bool _target){
+    return _reference_trajectory.empty() && (!_target || _target_trajectory.empty());
+}
+
+int NumericalSolver::DecoupledSolver::solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position, bool first_time_solving, int _drone_id, bool _target /*false*/,bool _multi/*false*/){
+    solver_success_ = COUPLED;
+    if(!isDecoupled(_target_trajectory, _reference_trajectory, _target)){
+        return solver_success_;
+    }
+    const State start = initialState(_uavs_pose, time_initial_position, first_time_solving, _drone_id);
+    const double p0[3] = {start.pose.x, start.pose.y, start.pose.z};
+    const double v0[3] = {start.velocity.x, start.velocity.y, start.velocity.z};
+    const double a0[3] = {first_time_solving ? 0.0 : start.acc.x, first_time_solving ? 0.0 : start.acc.y, first_time_solving ? 0.0 : start.acc.z};
+    const double desired[3] = {_desired_odometry.pose.pose.position.x, _desired_odometry.pose.pose.position.y, _desired_odometry.pose.pose.position.z};
+
+    // one axis after the other in the calling thread: each QP takes microseconds, less than starting a thread, and the solver thread
+    // keeps its real-time profile without allocating
+    bool solved = true;
+    for(int axis=0; axis<3 && solved; axis++){
+        solved = axes_[axis]->solve(desired[axis]-p0[axis], v0[axis], a0[axis], acc_[axis]);
+    }
+    if(!solved){
+        solver_success_ = AXIS_NOT_SOLVED;
+        for(int axis=0; axis<3; axis++){
+            acc_[axis].resize(0);  // don't warm start with a failed solve
+        }
+        return solver_success_;
+    }
+
+    for(int axis=0; axis<3; axis++){
+        AxisMPC::integrate(axes_[axis]->parameters(), p0[axis], v0[axis], acc_[axis], position_[axis], velocity_[axis]);
+    }
+    for(int i=0; i<time_horizon_; i++){
+        grid_solution_[i].pose.x = position_[0](i);
+        grid_solution_[i].pose.y = position_[1](i);
+        grid_solution_[i].pose.z = position_[2](i);
+        grid_solution_[i].velocity.x = velocity_[0](i);
+        grid_solution_[i].velocity.y = velocity_[1](i);
+        grid_solution_[i].velocity.z = velocity_[2](i);
+        grid_solution_[i].acc.x = acc_[0](i);
+        grid_solution_[i].acc.y = acc_[1](i);
+        grid_solution_[i].acc.z = acc_[2](i);
+    }
+    setSolution(grid_solution_.data(), time_initial_position, first_time_solving);
+    solver_success_ = returnValueType::SUCCESSFUL_RETURN;
+    return solver_success_;
+}
@@ -0,0 +1,51 @@
+#include <dense_qp.h>
+#include <algorithm>
+
+NumericalSolver::DenseQP::DenseQP(const Eigen::MatrixXd &P, const Eigen::MatrixXd &A, const double rho, const double sigma)
+    : P_(P), A_(A), AtA_(A.transpose() * A), rho_(rho), sigma_(sigma), z_(Eigen::VectorXd::Zero(A.rows())), y_(Eigen::VectorXd::Zero(A.rows())) {
+  kkt_.compute(P_ + sigma_ * Eigen::MatrixXd::Identity(P_.rows(), P_.cols()) + rho_ * AtA_);
+}
+
+void NumericalSolver::DenseQP::setHessian(const Eigen::MatrixXd &P) {
+  P_ = P;
+  kkt_.compute(P_ + sigma_ * Eigen::MatrixXd::Identity(P_.rows(), P_.cols()) + rho_ * AtA_);
+}
+
+int NumericalSolver::DenseQP::solve(const Eigen::VectorXd &q, const Eigen::VectorXd &l, const Eigen::VectorXd &u, Eigen::VectorXd &x) {
+  if (x.size() != P_.rows()) {
+    x = Eigen::VectorXd::Zero(P_.rows());
+    y_.setZero();
+  }
+  z_ = (A_ * x).cwiseMax(l).cwiseMin(u);
+
+  Eigen::VectorXd ax;
+  for (int iteration = 1; iteration <= max_iterations_; iteration++) {
+    x  = kkt_.solve(sigma_ * x - q + A_.transpose() * (rho_ * z_ - y_));
+    ax = A_ * x;
+    z_ = (ax + y_ / rho_).cwiseMax(l).cwiseMin(u);
+    y_ += rho_ * (ax - z_);
+
+    // the residuals cost as much as the iteration, so they are not checked in every one
+    if (iteration % CHECK_ITERATIONS != 0) {
+      continue;
+    }
+    const Eigen::VectorXd px              = P_ * x;
+    const Eigen::VectorXd aty             = A_.transpose() * y_;
+    const double          primal_residual = (ax - z_).lpNorm<Eigen::Infinity>();
+    const double          dual_residual   = (px + q + aty).lpNorm<Eigen::Infinity>();
+    if (primal_residual < tolerance_ && dual_residual < tolerance_) {
+      return iteration;
+    }
+    // balance the residuals changing the penalty, as OSQP does. The linear system is small, so factorizing it again is cheap
+    if (iteration % RHO_UPDATE_ITERATIONS == 0) {
+      const double primal_scale = std::max({ax.lpNorm<Eigen::Infinity>(), z_.lpNorm<Eigen::Infinity>(), 1e-10});
+      const double dual_scale   = std::max({px.lpNorm<Eigen::Infinity>(), aty.lpNorm<Eigen::Infinity>(), q.lpNorm<Eigen::Infinity>(), 1e-10});
+      const double ratio        = sqrt((primal_residual / primal_scale) / std::max(dual_residual / dual_scale, 1e-10));
+      if (ratio > 5.0 || ratio < 0.2) {
+        rho_ = std::min(std::max(rho_ * ratio, 1e-6), 1e6);
+        kkt_.compute(P_ + sigma_ * Eigen::MatrixXd::Identity(P_.rows(), P_.cols()) + rho_ * AtA_);
+      }
+    }
+  }
+  return -1;
+}
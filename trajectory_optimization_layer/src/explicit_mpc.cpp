@@ -0,0 +1,186 @@
+#include <explicit_mpc.h>
+#include <fstream>
+
+NumericalSolver::ExplicitMPC::ExplicitMPC(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess) : Solver(solving_rate, time_horizon, initial_guess){
+
+}
+
+NumericalSolver::AxisParameters NumericalSolver::ExplicitMPC::axisParameters(const int axis) const{
+    AxisParameters parameters;
+    parameters.time_horizon = time_horizon_;
+    parameters.step_size    = step_size;
+    parameters.max_vel      = axis < 2 ? MAX_VEL_XY : MAX_VEL_Z;
+    parameters.max_acc      = MAX_ACC;
+    parameters.w_acc        = axis == 0 ? W_AX : (axis == 1 ? W_AY : W_AZ);
+    parameters.w_end        = axis == 0 ? W_PX_N : (axis == 1 ? W_PY_N : 0.0);  // the end term of the ACADO problem is only on x and y
+    return parameters;
+}
+
+int NumericalSolver::ExplicitMPC::generate(const Range &displacement, const int velocity_points, const int acceleration_points){
+    int not_solved = 0;
+    for(int axis=0; axis<3; axis++){
+        AxisTable &table = tables_[axis];
+        table.parameters = axisParameters(axis);
+        table.displacement = axis < 2 ? displacement : Range();
+        table.velocity.min = -table.parameters.max_vel;
+        table.velocity.max = table.parameters.max_vel;
+        table.velocity.points = velocity_points;
+        table.acceleration.min = -table.parameters.max_acc;
+        table.acceleration.max = table.parameters.max_acc;
+        table.acceleration.points = acceleration_points;
+        table.acc.assign(table.displacement.points*velocity_points*acceleration_points*time_horizon_, 0.0);
+        table.valid.assign(table.displacement.points*velocity_points*acceleration_points, 0);
+
+        AxisMPC mpc(table.parameters);
+        Eigen::VectorXd acc;  // warm start with the neighbour
+        for(int d=0; d<table.displacement.points; d++){
+            for(int v=0; v<table.velocity.points; v++){
+                for(int a=0; a<table.acceleration.points; a++){
+                    const int index = table.index(d,v,a);
+                    if(mpc.solve(table.displacement.value(d), table.velocity.value(v), table.acceleration.value(a), acc)){
+                        table.valid[index] = 1;
+                        for(int k=0; k<time_horizon_; k++){
+                            table.acc[index*time_horizon_+k] = acc(k);
+                        }
+                    }else{
+                        not_solved++;
+                    }
+                }
+            }
+        }
+    }
+    loaded_ = true;
+    return not_solved;
+}
+
+bool NumericalSolver::ExplicitMPC::save(const std::string &path) const{
+    std::ofstream file(path, std::ios::binary);
+    if(!file.is_open()){
+        return false;
+    }
+    const int header[2] = {FILE_VERSION, time_horizon_};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for(const AxisTable &table : tables_){
+        file.write(reinterpret_cast<const char*>(&table.parameters), sizeof(AxisParameters));
+        file.write(reinterpret_cast<const char*>(&table.displacement), sizeof(Range));
+        file.write(reinterpret_cast<const char*>(&table.velocity), sizeof(Range));
+        file.write(reinterpret_cast<const char*>(&table.acceleration), sizeof(Range));
+        file.write(reinterpret_cast<const char*>(table.acc.data()), sizeof(float)*table.acc.size());
+        file.write(reinterpret_cast<const char*>(table.valid.data()), table.valid.size());
+    }
+    return file.good();
+}
+
+bool NumericalSolver::ExplicitMPC::load(const std::string &path){
+    loaded_ = false;
+    std::ifstream file(path, std::ios::binary);
+    int header[2] = {0, 0};
+    if(!file.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != FILE_VERSION || header[1] != time_horizon_){
+        return false;
+    }
+    for(int axis=0; axis<3; axis++){
+        AxisTable &table = tables_[axis];
+        file.read(reinterpret_cast<char*>(&table.parameters), sizeof(AxisParameters));
+        file.read(reinterpret_cast<char*>(&table.displacement), sizeof(Range));
+        file.read(reinterpret_cast<char*>(&table.velocity), sizeof(Range));
+        file.read(reinterpret_cast<char*>(&table.acceleration), sizeof(Range));
+        // the table is only valid for the problem it was generated for
+        if(!file || !(table.parameters == axisParameters(axis)) || table.displacement.points < 1 || table.velocity.points < 1 || table.acceleration.points < 1){
+            return false;
+        }
+        const int points = table.displacement.points*table.velocity.points*table.acceleration.points;
+        table.acc.resize(points*time_horizon_);
+        table.valid.resize(points);
+        file.read(reinterpret_cast<char*>(table.acc.data()), sizeof(float)*table.acc.size());
+        file.read(reinterpret_cast<char*>(table.valid.data()), table.valid.size());
+        if(!file){
+            return false;
+        }
+    }
+    loaded_ = true;
+    return true;
+}
+
+/** \brief cell and weight of a value in a range
+ *  \return false if the value is out of the range
+ */
+static bool cell(const NumericalSolver::ExplicitMPC::Range &range, const double value, int &i, double &w){
+    if(range.points == 1){  // dimension not used
+        i = 0;
+        w = 0.0;
+        return true;
+    }
+    const double t = (value-range.min)/(range.max-range.min)*(range.points-1);
+    if(t < -1e-9 || t > range.points-1+1e-9){
+        return false;
+    }
+    i = std::min(std::max((int)floor(t), 0), range.points-2);
+    w = std::min(std::max(t-i, 0.0), 1.0);
+    return true;
+}
+
+bool NumericalSolver::ExplicitMPC::interpolate(const AxisTable &table, const double displacement, const double v0, const double a0, Eigen::VectorXd &acc) const{
+    int id, iv, ia;
+    double wd, wv, wa;
+    if(!cell(table.displacement, displacement, id, wd) || !cell(table.velocity, v0, iv, wv) || !cell(table.acceleration, a0, ia, wa)){
+        return false;
+    }
+    acc = Eigen::VectorXd::Zero(time_horizon_);
+    // trilinear interpolation over the 8 neighbours
+    for(int corner=0; corner<8; corner++){
+        const int dd = corner & 1, dv = (corner >> 1) & 1, da = (corner >> 2) & 1;
+        const double weight = (dd ? wd : 1-wd)*(dv ? wv : 1-wv)*(da ? wa : 1-wa);
+        if(weight == 0.0){
+            continue;
+        }
+        const int index = table.index(id+dd, iv+dv, ia+da);
+        if(!table.valid[index]){
+            return false;
+        }
+        acc += weight*Eigen::Map<const Eigen::VectorXf>(&table.acc[index*time_horizon_], time_horizon_).cast<double>();
+    }
+    return true;
+}
+
+int NumericalSolver::ExplicitMPC::solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position, bool first_time_solving, int _drone_id, bool _target /*false*/,bool _multi/*false*/){
+    solver_success_ = OUT_OF_DOMAIN;
+    if(!loaded_ || !_reference_trajectory.empty()){
+        return solver_success_;
+    }
+    const State start = initialState(_uavs_pose, time_initial_position, first_time_solving, _drone_id);
+    const double p0[3] = {start.pose.x, start.pose.y, start.pose.z};
+    const double v0[3] = {start.velocity.x, start.velocity.y, start.velocity.z};
+    const double a0[3] = {first_time_solving ? 0.0 : start.acc.x, first_time_solving ? 0.0 : start.acc.y, first_time_solving ? 0.0 : start.acc.z};
+    const double desired[3] = {_desired_odometry.pose.pose.position.x, _desired_odometry.pose.pose.position.y, _desired_odometry.pose.pose.position.z};
+
+    Eigen::VectorXd acc[3], position[3], velocity[3];
+    for(int axis=0; axis<3; axis++){
+        if(!interpolate(tables_[axis], desired[axis]-p0[axis], v0[axis], a0[axis], acc[axis])){
+            return solver_success_;
+        }
+        AxisMPC::integrate(tables_[axis].parameters, p0[axis], v0[axis], acc[axis], position[axis], velocity[axis]);
+    }
+    std::vector<State> grid_solution(time_horizon_);
+    for(int i=0; i<time_horizon_; i++){
+        grid_solution[i].pose.x = position[0](i);
+        grid_solution[i].pose.y = position[1](i);
+        grid_solution[i].pose.z = position[2](i);
+        grid_solution[i].velocity.x = velocity[0](i);
+        grid_solution[i].velocity.y = velocity[1](i);
+        grid_solution[i].velocity.z = velocity[2](i);
+        grid_solution[i].acc.x = acc[0](i);
+        grid_solution[i].acc.y = acc[1](i);
+        grid_solution[i].acc.z = acc[2](i);
+    }
+    // the height constraint over the target must be inactive, otherwise the problem is coupled
+    if(_target){
+        for(uint i=0; i<time_horizon_ && i<_target_trajectory.size(); i++){
+            if(grid_solution[i].pose.z < _target_trajectory[i].pose.pose.position.z+Z_RELATIVE_TARGET_DRONE){
+                return solver_success_;
+            }
+        }
+    }
+    setSolution(grid_solution.data(), time_initial_position, first_time_solving);
+    solver_success_ = returnValueType::SUCCESSFUL_RETURN;
+    return solver_success_;
+}
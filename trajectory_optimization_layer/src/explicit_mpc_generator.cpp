@@ -0,0 +1,27 @@
+#include <explicit_mpc.h>
+
+/** Offline generation of the explicit MPC table for the waypoint shots
+ *  Usage: explicit_mpc_generator <output_file> [max_displacement] [displacement_points]
+ *  Set the solver's explicit_mpc_file param to output_file. The table must be generated again if the horizon, bounds or weights of the solver change
+ */
+int main(int _argc, char **_argv) {
+  if (_argc < 2) {
+    std::cout << "usage: explicit_mpc_generator <output_file> [max_displacement] [displacement_points]" << std::endl;
+    return 1;
+  }
+  const int                              time_horizon = 40;
+  NumericalSolver::ExplicitMPC::Range    displacement;
+  displacement.max    = _argc > 2 ? std::stod(_argv[2]) : 20.0;
+  displacement.min    = -displacement.max;
+  displacement.points = _argc > 3 ? std::stoi(_argv[3]) : 81;
+
+  std::shared_ptr<State[]>     initial_guess(new State[time_horizon]);
+  NumericalSolver::ExplicitMPC explicit_mpc(1.0, time_horizon, initial_guess);
+  const int                    not_solved = explicit_mpc.generate(displacement);
+  std::cout << "explicit MPC table generated, " << not_solved << " grid points with the initial state out of the constraints" << std::endl;
+  if (!explicit_mpc.save(_argv[1])) {
+    std::cout << ANSI_COLOR_RED << "error writing " << _argv[1] << ANSI_COLOR_RESET << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include <forces_backend.h>
+#include <pluginlib/class_list_macros.h>
+
+void NumericalSolver::ForcesBackend::initialize(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess){
+    variants_.clear();
+    int threads = 0;
+    ros::param::param("~forces_evaluation_threads", threads, threads);
+    pool_ = std::make_unique<StagePool>(std::max(threads, 0), MIN_STAGES_PER_THREAD);
+#ifdef FORCES_HAS_FORCESNLPsolver_40
+    variants_.push_back(std::make_unique<ForcesModelVariant<FORCESNLPsolver_40_model>>(*pool_));
+#elif defined(FORCES_HAS_FORCESNLPsolver)
+    variants_.push_back(std::make_unique<ForcesModelVariant<FORCESNLPsolver_model>>(*pool_));
+#endif
+#ifdef FORCES_HAS_FORCESNLPsolver_100
+    variants_.push_back(std::make_unique<ForcesModelVariant<FORCESNLPsolver_100_model>>(*pool_));
+#endif
+    std::sort(variants_.begin(), variants_.end(), [](const std::unique_ptr<ForcesVariant> &a, const std::unique_ptr<ForcesVariant> &b){
+        return a->horizon() < b->horizon();
+    });
+    const int max_horizon = std::max(time_horizon, variants_.empty() ? 0 : variants_.back()->horizon());
+    for(const std::unique_ptr<ForcesVariant> &variant : variants_){
+        ROS_INFO("FORCES backend: solver %s, %d steps, stages evaluated in %d threads", variant->name(), variant->horizon(), pool_->threads()+1);
+    }
+    time_horizon_ = time_horizon;
+    initial_guess_ = initial_guess;
+    solution_.reset(new State[time_horizon]);
+    variant_guess_.resize(max_horizon);
+    variant_solution_.resize(max_horizon);
+}
+
+NumericalSolver::ForcesVariant *NumericalSolver::ForcesBackend::select(const SolverProblem &problem) const{
+    // steps of look-ahead: the target is followed along the whole horizon, a waypoint only until it is reached
+    int needed = time_horizon_;
+    if(!problem.target){
+        const State &uav = problem.uavs_pose.at(problem.drone_id).state;
+        const double distance = sqrt(pow(problem.desired_odometry.pose.pose.position.x-uav.pose.x, 2)+pow(problem.desired_odometry.pose.pose.position.y-uav.pose.y, 2));
+        needed = std::min<int>(needed, ceil(distance/MAX_VEL/STEP_SIZE)+1);
+    }
+    if(options_.horizon > 0){
+        needed = std::min(needed, options_.horizon);
+    }
+
+    ForcesVariant *longest = nullptr, *fastest = nullptr;
+    for(const std::unique_ptr<ForcesVariant> &variant : variants_){
+        if(!variant->accepts(problem)){
+            continue;
+        }
+        if(!fastest || variant->mean_time < fastest->mean_time){
+            fastest = variant.get();
+        }
+        // a solver that has not been used yet is assumed to fit in the budget
+        if(variant->solves > 0 && variant->mean_time > options_.max_time){
+            continue;
+        }
+        if(variant->horizon() >= needed){
+            return variant.get();
+        }
+        longest = variant.get();
+    }
+    return longest ? longest : fastest;
+}
+
+NumericalSolver::SolverResult NumericalSolver::ForcesBackend::solve(SolverProblem &problem){
+    SolverResult result;
+    ForcesVariant *variant = select(problem);
+    if(!variant){
+        ROS_ERROR_THROTTLE(1.0, "FORCES backend: no generated solver has the features of the shot (target, no fly zone)");
+        return result;
+    }
+    const int horizon = variant->horizon();
+    const int kept = std::min(horizon, time_horizon_);
+    // the initial guess of the steps after the time horizon holds its last state
+    std::copy(initial_guess_.get(), initial_guess_.get()+kept, variant_guess_.begin());
+    std::fill(variant_guess_.begin()+kept, variant_guess_.begin()+horizon, initial_guess_[time_horizon_-1]);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    State initial_state = problem.uavs_pose.at(problem.drone_id).state;
+    const State followed = problem.first_time_solving ? State() : Solver::interpolate(solution_.get(), time_horizon_,
+                                                                                      std::chrono::duration<double>(start-last_solve_).count(), STEP_SIZE);
+    initial_state.acc = followed.acc;
+    result.status = variant->solve(initial_state, variant_guess_.data(), problem, variant_solution_.data());
+    last_solve_ = start;
+    result.solving_time = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    result.success = (result.status == 1);
+    result.converged = result.success;
+    variant->mean_time = variant->solves == 0 ? result.solving_time : 0.8*variant->mean_time+0.2*result.solving_time;
+    variant->solves++;
+    ROS_DEBUG("FORCES backend: %s solved in %f s, status %d. Sweeps evaluated in parallel %d, stages evaluated serially %d", variant->name(),
+              result.solving_time, result.status, variant->aheadSweeps(), variant->serialStages());
+
+    std::copy(variant_solution_.begin(), variant_solution_.begin()+kept, solution_.get());
+    if(kept < time_horizon_){
+        Solver::brake(solution_.get(), kept-1, time_horizon_, STEP_SIZE, MAX_ACC);
+    }
+    return result;
+}
+
+PLUGINLIB_EXPORT_CLASS(NumericalSolver::ForcesBackend, NumericalSolver::SolverBackend)
@@ -0,0 +1,67 @@
+#include <forces_stage_evaluator.h>
+
+NumericalSolver::StagePool::StagePool(const int threads, const int min_chunk) : min_chunk_(std::max(min_chunk, 1)){
+    for(int thread=0; thread<threads; thread++){
+        workers_.emplace_back(&StagePool::worker, this, thread+1);
+    }
+}
+
+NumericalSolver::StagePool::~StagePool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for(std::thread &worker : workers_){
+        worker.join();
+    }
+}
+
+void NumericalSolver::StagePool::run(const int stages, Function function, void *context){
+    const int chunks = std::min<int>(workers_.size()+1, std::max(stages/min_chunk_, 1));
+    if(chunks == 1){
+        function(context, 0, stages);
+        return;
+    }
+    const int chunk_size = (stages+chunks-1)/chunks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        function_ = function;
+        context_ = context;
+        chunks_ = chunks;
+        chunk_size_ = chunk_size;
+        stages_ = stages;
+        pending_ = chunks-1;
+        run_++;
+    }
+    start_.notify_all();
+    function(context, 0, chunk_size);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]{ return pending_ == 0; });
+}
+
+void NumericalSolver::StagePool::worker(const int thread){
+    unsigned last_run = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true){
+        start_.wait(lock, [this, last_run]{ return stop_ || run_ != last_run; });
+        if(stop_){
+            return;
+        }
+        last_run = run_;
+        // the threads beyond the chunks of this run wait for the next one
+        if(thread >= chunks_){
+            continue;
+        }
+        const int begin = thread*chunk_size_;
+        const int end = std::min(begin+chunk_size_, stages_);
+        Function function = function_;
+        void *context = context_;
+        lock.unlock();
+        function(context, begin, end);
+        lock.lock();
+        if(--pending_ == 0){
+            done_.notify_one();
+        }
+    }
+}
@@ -54,11 +54,12 @@ void SolverUtils::Logger::logging() {
 
 void SolverUtils::Logger::loggingCalculatedTrajectory(const int solver_success) {
   file_ << "solver_success: " << solver_success << std::endl;
+  file_ << "solving time: " << class_to_log_ptr_->solver_result_.solving_time << std::endl;
   file_ << "Calculated trajectroy" << std::endl;
   for (int i = 0; i < class_to_log_ptr_->time_horizon_; i++) {
-    file_ << class_to_log_ptr_->solver_pt_->solution_[i].acc.x << ", " << class_to_log_ptr_->solver_pt_->solution_[i].acc.y << ", " << class_to_log_ptr_->solver_pt_->solution_[i].acc.z
-      << ", " << class_to_log_ptr_->solver_pt_->solution_[i].pose.x << ", " << class_to_log_ptr_->solver_pt_->solution_[i].pose.y << ", " << class_to_log_ptr_->solver_pt_->solution_[i].pose.z
-     << ", " << class_to_log_ptr_->solver_pt_->solution_[i].velocity.x << ", " << class_to_log_ptr_->solver_pt_->solution_[i].velocity.y << ", "<< class_to_log_ptr_->solver_pt_->solution_[i].velocity.z<< std::endl;
+    file_ << class_to_log_ptr_->solver_pt_->solution()[i].acc.x << ", " << class_to_log_ptr_->solver_pt_->solution()[i].acc.y << ", " << class_to_log_ptr_->solver_pt_->solution()[i].acc.z
+      << ", " << class_to_log_ptr_->solver_pt_->solution()[i].pose.x << ", " << class_to_log_ptr_->solver_pt_->solution()[i].pose.y << ", " << class_to_log_ptr_->solver_pt_->solution()[i].pose.z
+     << ", " << class_to_log_ptr_->solver_pt_->solution()[i].velocity.x << ", " << class_to_log_ptr_->solver_pt_->solution()[i].velocity.y << ", "<< class_to_log_ptr_->solver_pt_->solution()[i].velocity.z<< std::endl;
   }
 }
 
@@ -67,19 +68,20 @@ void SolverUtils::Logger::loggingCalculatedTrajectory(const int solver_success)
  */
 
 void SolverUtils::Logger::publishPath() {
-  nav_msgs::Path                          msg;
-  std::vector<geometry_msgs::PoseStamped> poses(class_to_log_ptr_->time_horizon_);
-  msg.header.frame_id = class_to_log_ptr_->trajectory_frame_;
+  // in the arena of the cycle of the solver
+  nav_msgs::Path_<ArenaAllocator<void>> msg(class_to_log_ptr_->cycle_arena_.allocator<void>());
+  const std::string                    &frame = class_to_log_ptr_->trajectory_frame_;
+  msg.header.frame_id.assign(frame.data(), frame.size());
+  msg.poses.resize(class_to_log_ptr_->time_horizon_);
   for (int i = 0; i < class_to_log_ptr_->time_horizon_; i++) {
-    poses.at(i).pose.position.x    =class_to_log_ptr_->solution_[i].pose.x;
-    poses.at(i).pose.position.y    =class_to_log_ptr_->solution_[i].pose.y;
-    poses.at(i).pose.position.z    =class_to_log_ptr_->solution_[i].pose.z;
-    poses.at(i).pose.orientation.x = 0;
-    poses.at(i).pose.orientation.y = 0;
-    poses.at(i).pose.orientation.z = 0;
-    poses.at(i).pose.orientation.w = 1;
+    msg.poses.at(i).pose.position.x    =class_to_log_ptr_->solution_[i].pose.x;
+    msg.poses.at(i).pose.position.y    =class_to_log_ptr_->solution_[i].pose.y;
+    msg.poses.at(i).pose.position.z    =class_to_log_ptr_->solution_[i].pose.z;
+    msg.poses.at(i).pose.orientation.x = 0;
+    msg.poses.at(i).pose.orientation.y = 0;
+    msg.poses.at(i).pose.orientation.z = 0;
+    msg.poses.at(i).pose.orientation.w = 1;
   }
-  msg.poses = poses;
   path_rviz_pub.publish(msg);
 }
 
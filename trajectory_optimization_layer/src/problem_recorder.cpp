@@ -0,0 +1,172 @@
+#include <problem_recorder.h>
+
+namespace {
+
+template <class T>
+void writeValue(std::ostream &output, const T &value) {
+  output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T>
+bool readValue(std::istream &input, T &value) {
+  return static_cast<bool>(input.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+template <class T>
+void writeVector(std::ostream &output, const std::vector<T> &vector) {
+  writeValue(output, static_cast<uint32_t>(vector.size()));
+  output.write(reinterpret_cast<const char *>(vector.data()), sizeof(T) * vector.size());
+}
+
+template <class T>
+bool readVector(std::istream &input, std::vector<T> &vector) {
+  uint32_t size;
+  if (!readValue(input, size)) {
+    return false;
+  }
+  vector.resize(size);
+  return static_cast<bool>(input.read(reinterpret_cast<char *>(vector.data()), sizeof(T) * size));
+}
+
+}  // namespace
+
+SolverUtils::ProblemRecorder::ProblemRecorder(const int time_horizon, const size_t capacity) : time_horizon_(time_horizon), queue_(std::max<size_t>(1, capacity)) {
+  // the vectors are allocated here, so filling a record does not allocate in the control loop
+  for (Record &record : queue_) {
+    record.previous_solution.reserve(time_horizon_);
+    record.initial_guess.reserve(time_horizon_);
+    record.target_trajectory.reserve(time_horizon_);
+    record.reference_trajectory.reserve(time_horizon_);
+    record.solution.reserve(time_horizon_);
+    record.uavs.reserve(8);
+  }
+}
+
+SolverUtils::ProblemRecorder::~ProblemRecorder() {
+  running_ = false;
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  if (dropped_ > 0) {
+    ROS_WARN("Problem recorder: %zu planning steps were not captured, the writer was too slow", dropped_);
+  }
+}
+
+bool SolverUtils::ProblemRecorder::open(const std::string &path) {
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_.is_open()) {
+    ROS_ERROR("Problem recorder: error opening %s", path.c_str());
+    return false;
+  }
+  // header: magic, version, time horizon
+  const int header[3] = {MAGIC, FILE_VERSION, time_horizon_};
+  file_.write(reinterpret_cast<const char *>(header), sizeof(header));
+  running_ = true;
+  writer_  = std::thread(&ProblemRecorder::writer, this);
+  return true;
+}
+
+SolverUtils::ProblemRecorder::Record *SolverUtils::ProblemRecorder::begin() {
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (!running_) {
+    return nullptr;
+  }
+  if (head - tail_.load(std::memory_order_acquire) >= queue_.size()) {
+    dropped_++;
+    return nullptr;
+  }
+  Record &record = queue_[head % queue_.size()];
+  record.step    = steps_++;
+  return &record;
+}
+
+void SolverUtils::ProblemRecorder::commit() {
+  head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void SolverUtils::ProblemRecorder::writer() {
+  // the records queued before closing are saved too
+  while (running_ || tail_.load(std::memory_order_relaxed) != head_.load(std::memory_order_acquire)) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      file_.flush();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      continue;
+    }
+    write(queue_[tail % queue_.size()]);
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+  file_.close();
+}
+
+void SolverUtils::ProblemRecorder::write(const Record &record) {
+  writeValue(file_, record.step);
+  writeValue(file_, record.time);
+  writeValue(file_, record.initial_time);
+  writeValue(file_, record.drone_id);
+  writeValue(file_, record.shot_type);
+  writeValue(file_, record.first_time_solving);
+  writeValue(file_, record.target);
+  writeValue(file_, record.multi);
+  writeValue(file_, record.options.tolerance_scale);
+  writeValue(file_, record.options.max_time);
+  writeValue(file_, record.options.horizon);
+  writeVector(file_, record.options.time_grid);
+  writeValue(file_, record.options.discrete_dynamics);
+  writeValue(file_, record.desired);
+  writeVector(file_, record.no_fly_zone);
+  writeVector(file_, record.previous_solution);
+  writeVector(file_, record.initial_guess);
+  writeVector(file_, record.target_trajectory);
+  writeVector(file_, record.reference_trajectory);
+  writeVector(file_, record.uavs);
+  writeValue(file_, record.status);
+  writeValue(file_, record.solving_time);
+  writeVector(file_, record.solution);
+}
+
+bool SolverUtils::ProblemRecorder::readHeader(std::istream &input, int &time_horizon) {
+  int magic, version;
+  return readValue(input, magic) && magic == MAGIC && readValue(input, version) && version == FILE_VERSION && readValue(input, time_horizon);
+}
+
+bool SolverUtils::ProblemRecorder::read(std::istream &input, Record &record) {
+  return readValue(input, record.step) && readValue(input, record.time) && readValue(input, record.initial_time) && readValue(input, record.drone_id) &&
+         readValue(input, record.shot_type) && readValue(input, record.first_time_solving) && readValue(input, record.target) &&
+         readValue(input, record.multi) && readValue(input, record.options.tolerance_scale) && readValue(input, record.options.max_time) &&
+         readValue(input, record.options.horizon) && readVector(input, record.options.time_grid) && readValue(input, record.options.discrete_dynamics) &&
+         readValue(input, record.desired) && readVector(input, record.no_fly_zone) &&
+         readVector(input, record.previous_solution) && readVector(input, record.initial_guess) && readVector(input, record.target_trajectory) &&
+         readVector(input, record.reference_trajectory) && readVector(input, record.uavs) && readValue(input, record.status) &&
+         readValue(input, record.solving_time) && readVector(input, record.solution);
+}
+
+State SolverUtils::ProblemRecorder::toState(const nav_msgs::Odometry &odometry) {
+  State state;
+  state.pose.x       = odometry.pose.pose.position.x;
+  state.pose.y       = odometry.pose.pose.position.y;
+  state.pose.z       = odometry.pose.pose.position.z;
+  state.quaternion.x = odometry.pose.pose.orientation.x;
+  state.quaternion.y = odometry.pose.pose.orientation.y;
+  state.quaternion.z = odometry.pose.pose.orientation.z;
+  state.quaternion.w = odometry.pose.pose.orientation.w;
+  state.velocity.x   = odometry.twist.twist.linear.x;
+  state.velocity.y   = odometry.twist.twist.linear.y;
+  state.velocity.z   = odometry.twist.twist.linear.z;
+  return state;
+}
+
+nav_msgs::Odometry SolverUtils::ProblemRecorder::toOdometry(const State &state) {
+  nav_msgs::Odometry odometry;
+  odometry.pose.pose.position.x    = state.pose.x;
+  odometry.pose.pose.position.y    = state.pose.y;
+  odometry.pose.pose.position.z    = state.pose.z;
+  odometry.pose.pose.orientation.x = state.quaternion.x;
+  odometry.pose.pose.orientation.y = state.quaternion.y;
+  odometry.pose.pose.orientation.z = state.quaternion.z;
+  odometry.pose.pose.orientation.w = state.quaternion.w;
+  odometry.twist.twist.linear.x    = state.velocity.x;
+  odometry.twist.twist.linear.y    = state.velocity.y;
+  odometry.twist.twist.linear.z    = state.velocity.z;
+  return odometry;
+}
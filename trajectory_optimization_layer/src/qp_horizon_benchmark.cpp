@@ -0,0 +1,81 @@
+#include <condensed_qp_solver.h>
+#include <riccati_qp_solver.h>
+
+namespace {
+
+struct Timing {
+  int    status     = 0;
+  double time       = 0.0;  // mean solving time (s)
+  int    iterations = 0;    // ADMM iterations of a solve
+};
+
+/** Waypoint shot with the target close and below the drone, so the pitch term and the height constraint are active all along the horizon
+ */
+template <class SolverType>
+Timing solveShot(const int time_horizon, const int repetitions) {
+  std::shared_ptr<State[]> initial_guess(new State[time_horizon]);
+  for (int k = 0; k < time_horizon; k++) {
+    initial_guess[k].pose.x = 1.0;
+    initial_guess[k].pose.z = 3.0;
+  }
+  SolverType solver(1.0, time_horizon, initial_guess);
+  solver.setOptions(NumericalSolver::SolverOptions{1.0, 10.0});
+
+  nav_msgs::Odometry desired;
+  desired.pose.pose.position.x = 8.0;
+  desired.pose.pose.position.y = -3.0;
+  desired.pose.pose.position.z = 3.0;
+  std::vector<nav_msgs::Odometry> target(time_horizon), reference;
+  for (int k = 0; k < time_horizon; k++) {
+    target[k].pose.pose.position.x = 4.0 + 0.05 * k * 0.2;
+    target[k].pose.pose.position.z = 1.0;
+  }
+  std::map<int, UavState> uavs_pose;
+  uavs_pose[1].state.pose.x = 1.0;
+  uavs_pose[1].state.pose.z = 3.0;
+  uavs_pose[1].has_pose     = true;
+
+  // the first solve allocates and warms up the caches, it is not measured
+  Timing timing;
+  timing.status = solver.solverFunction(desired, {}, target, reference, uavs_pose, 0, true, 1);
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions && timing.status == 0; i++) {
+    timing.status = solver.solverFunction(desired, {}, target, reference, uavs_pose, 0, true, 1);
+  }
+  timing.time       = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+  timing.iterations = solver.qp_iterations_;
+  return timing;
+}
+
+}  // namespace
+
+/** Scaling of the QP backends with the horizon, for the same shot
+ *  Usage: qp_horizon_benchmark [max_condensed_horizon] [repetitions]
+ *  The horizon goes from 20 to 400 steps. The condensed QP is only solved up to max_condensed_horizon (default 200), its factorization
+ *  grows with the cube of the horizon. For each backend the mean solving time, the ADMM iterations and the time per iteration are printed:
+ *  the time per iteration of the Riccati QP must grow linearly
+ */
+int main(int _argc, char **_argv) {
+  if (_argc > 3) {
+    std::cout << "usage: qp_horizon_benchmark [max_condensed_horizon] [repetitions]" << std::endl;
+    return 1;
+  }
+  const int max_condensed_horizon = _argc > 1 ? std::stoi(_argv[1]) : 200;
+  const int repetitions           = _argc > 2 ? std::stoi(_argv[2]) : 5;
+
+  std::cout << "horizon, riccati status, riccati time (ms), riccati iterations, riccati time per iteration (us), condensed status, condensed time (ms), "
+               "condensed iterations, condensed time per iteration (us)"
+            << std::endl;
+  for (const int time_horizon : {20, 40, 60, 100, 150, 200, 300, 400}) {
+    const Timing riccati = solveShot<NumericalSolver::RiccatiQPSolver>(time_horizon, repetitions);
+    std::cout << time_horizon << ", " << riccati.status << ", " << 1e3 * riccati.time << ", " << riccati.iterations << ", "
+              << 1e6 * riccati.time / std::max(riccati.iterations, 1);
+    if (time_horizon <= max_condensed_horizon) {
+      const Timing condensed = solveShot<NumericalSolver::CondensedQPSolver>(time_horizon, repetitions);
+      std::cout << ", " << condensed.status << ", " << 1e3 * condensed.time << ", " << condensed.iterations << ", "
+                << 1e6 * condensed.time / std::max(condensed.iterations, 1);
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
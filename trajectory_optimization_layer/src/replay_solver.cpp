@@ -0,0 +1,115 @@
+#include <problem_recorder.h>
+#include <solver_acado.h>
+#include <condensed_qp_solver.h>
+#include <riccati_qp_solver.h>
+#include <decoupled_solver.h>
+#include <boost/make_shared.hpp>
+#include <fstream>
+
+namespace {
+
+boost::shared_ptr<NumericalSolver::SolverBackend> createBackend(const std::string &name) {
+  if (name == "acado") {
+    return boost::make_shared<NumericalSolver::ACADOBackend>();
+  } else if (name == "condensed_qp") {
+    return boost::make_shared<NumericalSolver::CondensedQPBackend>();
+  } else if (name == "riccati_qp") {
+    return boost::make_shared<NumericalSolver::RiccatiQPBackend>();
+  } else if (name == "decoupled") {
+    return boost::make_shared<NumericalSolver::SolverPlugin<NumericalSolver::DecoupledSolver>>();
+  }
+  return nullptr;
+}
+
+double maxPositionDifference(const std::vector<State> &a, const State b[], const int size) {
+  double difference = 0.0;
+  for (int i = 0; i < size && i < (int)a.size(); i++) {
+    difference = std::max(difference, sqrt(pow(a[i].pose.x - b[i].pose.x, 2) + pow(a[i].pose.y - b[i].pose.y, 2) + pow(a[i].pose.z - b[i].pose.z, 2)));
+  }
+  return difference;
+}
+
+}  // namespace
+
+/** Replay of the planning steps captured by the solver (capture_file param)
+ *  Usage: replay_solver <capture_file> [backend] [first_step] [last_step] [tolerance_scale] [max_time] [horizon]
+ *  backend: acado (default), condensed_qp, riccati_qp or decoupled. The options are the captured ones if they are not given.
+ *  Every step is solved from its captured input, in order, with the same backend object, so a whole flight is replayed with warm starts
+ *  as online. For each step the captured and replayed status and solving time are printed, with the max position difference of the solutions
+ */
+int main(int _argc, char **_argv) {
+  if (_argc < 2) {
+    std::cout << "usage: replay_solver <capture_file> [backend] [first_step] [last_step] [tolerance_scale] [max_time] [horizon]" << std::endl;
+    return 1;
+  }
+  const std::string backend_name = _argc > 2 ? _argv[2] : "acado";
+  const uint32_t    first_step   = _argc > 3 ? std::stoul(_argv[3]) : 0;
+  const uint32_t    last_step    = _argc > 4 ? std::stoul(_argv[4]) : std::numeric_limits<uint32_t>::max();
+
+  std::ifstream input(_argv[1], std::ios::binary);
+  int           time_horizon;
+  if (!input.is_open() || !SolverUtils::ProblemRecorder::readHeader(input, time_horizon)) {
+    std::cout << ANSI_COLOR_RED << _argv[1] << " is not a capture file of this version" << ANSI_COLOR_RESET << std::endl;
+    return 1;
+  }
+  boost::shared_ptr<NumericalSolver::SolverBackend> backend = createBackend(backend_name);
+  if (!backend) {
+    std::cout << ANSI_COLOR_RED << "unknown backend " << backend_name << ANSI_COLOR_RESET << std::endl;
+    return 1;
+  }
+  std::shared_ptr<State[]> initial_guess(new State[time_horizon]);
+  backend->initialize(1.0, time_horizon, initial_guess);
+
+  SolverUtils::ProblemRecorder::Record record;
+  int                                  steps = 0, failures = 0;
+  double                               total_time = 0.0, max_time = 0.0, max_difference = 0.0;
+  std::cout << "step, captured status, captured time (s), replayed status, replayed time (s), max position difference (m)" << std::endl;
+  while (SolverUtils::ProblemRecorder::read(input, record) && record.step <= last_step) {
+    if (record.step < first_step || (int)record.initial_guess.size() != time_horizon || (int)record.previous_solution.size() != time_horizon) {
+      continue;
+    }
+    // captured input
+    NumericalSolver::SolverOptions options = record.options;
+    if (_argc > 5) options.tolerance_scale = std::stod(_argv[5]);
+    if (_argc > 6) options.max_time = std::stod(_argv[6]);
+    if (_argc > 7) options.horizon = std::stoi(_argv[7]);
+    backend->setOptions(options);
+    std::copy(record.previous_solution.begin(), record.previous_solution.end(), backend->solution());
+    std::copy(record.initial_guess.begin(), record.initial_guess.end(), initial_guess.get());
+    nav_msgs::Odometry              desired_odometry = SolverUtils::ProblemRecorder::toOdometry(record.desired);
+    std::vector<nav_msgs::Odometry> target_trajectory, reference_trajectory;
+    for (const State &state : record.target_trajectory) {
+      target_trajectory.push_back(SolverUtils::ProblemRecorder::toOdometry(state));
+    }
+    for (const State &state : record.reference_trajectory) {
+      reference_trajectory.push_back(SolverUtils::ProblemRecorder::toOdometry(state));
+    }
+    std::map<int, UavState> uavs_pose;
+    for (const std::pair<int32_t, State> &uav : record.uavs) {
+      uavs_pose[uav.first].state    = uav.second;
+      uavs_pose[uav.first].has_pose = true;
+    }
+
+    NumericalSolver::SolverProblem problem{desired_odometry, record.no_fly_zone, target_trajectory, reference_trajectory, uavs_pose,
+                                           record.initial_time, (bool)record.first_time_solving, record.drone_id, (bool)record.target, (bool)record.multi};
+    const NumericalSolver::SolverResult result     = backend->solve(problem);
+    const double                        difference = maxPositionDifference(record.solution, backend->solution(), time_horizon);
+    std::cout << record.step << ", " << record.status << ", " << record.solving_time << ", " << result.status << ", " << result.solving_time << ", "
+              << difference << std::endl;
+
+    steps++;
+    failures += !result.success;
+    total_time += result.solving_time;
+    max_time = std::max(max_time, result.solving_time);
+    if (result.success) {
+      max_difference = std::max(max_difference, difference);
+    }
+  }
+  if (steps == 0) {
+    std::cout << ANSI_COLOR_RED << "no steps replayed" << ANSI_COLOR_RESET << std::endl;
+    return 1;
+  }
+  std::cout << ANSI_COLOR_GREEN << steps << " steps replayed with " << backend_name << ": " << failures << " failures, solving time mean " << total_time / steps
+            << " s max " << max_time << " s, max position difference " << max_difference << " m" << ANSI_COLOR_RESET << std::endl;
+  return 0;
+}
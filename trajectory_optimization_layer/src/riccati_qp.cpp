@@ -0,0 +1,96 @@
+#include <riccati_qp.h>
+#include <algorithm>
+
+NumericalSolver::RiccatiQP::RiccatiQP(const int stages, const StateMatrix &A, const InputMatrix &B, const ConstraintMatrix &G, const double rho, const double sigma)
+    : A_(A), B_(B), G_(G), GtG_(G.transpose() * G), rho_(rho), sigma_(sigma), stages_(stages), workspace_(stages), active_stages_(stages) {
+  for (Workspace &workspace : workspace_) {
+    workspace.z.setZero();
+    workspace.y.setZero();
+  }
+  factorize();
+}
+
+void NumericalSolver::RiccatiQP::factorize() {
+  // cost to go V_k(x) = 1/2 x'S_k x + s_k'x, from the last stage to the first one
+  const int N = active_stages_;
+  for (int k = N - 1; k >= 0; k--) {
+    Workspace &workspace = workspace_[k];
+    StageMatrix Q        = stages_[k].P + sigma_ * StageMatrix::Identity() + rho_ * GtG_;
+    if (k + 1 < N) {
+      const StateMatrix &S = workspace_[k + 1].S;
+      Q.topLeftCorner<NX, NX>() += A_.transpose() * S * A_;
+      Q.bottomLeftCorner<NU, NX>() += B_.transpose() * S * A_;
+      Q.bottomRightCorner<NU, NU>() += B_.transpose() * S * B_;
+    }
+    workspace.qux = Q.bottomLeftCorner<NU, NX>();
+    workspace.quu.compute(Q.bottomRightCorner<NU, NU>());
+    workspace.K = -workspace.quu.solve(workspace.qux);
+    workspace.S = Q.topLeftCorner<NX, NX>() + workspace.qux.transpose() * workspace.K;
+    workspace.S = 0.5 * (workspace.S + workspace.S.transpose()).eval();
+  }
+}
+
+int NumericalSolver::RiccatiQP::solve(const StateVector &x0) {
+  const int N = active_stages_;
+  for (int k = 0; k < N; k++) {
+    workspace_[k].z = (G_ * stages_[k].w).cwiseMax(stages_[k].lower).cwiseMin(stages_[k].upper);
+  }
+
+  for (int iteration = 1; iteration <= max_iterations_; iteration++) {
+    // backward pass of the linear terms: the cost of the stage is 1/2 w'(P + sigma I + rho G'G)w + (q - sigma w_prev + G'(y - rho z))'w
+    for (int k = N - 1; k >= 0; k--) {
+      Workspace        &workspace = workspace_[k];
+      const StageVector gradient  = stages_[k].q - sigma_ * stages_[k].w + G_.transpose() * (workspace.y - rho_ * workspace.z);
+      StateVector       qx        = gradient.head<NX>();
+      Eigen::Matrix<double, NU, 1> qu = gradient.tail<NU>();
+      if (k + 1 < N) {
+        qx += A_.transpose() * workspace_[k + 1].s;
+        qu += B_.transpose() * workspace_[k + 1].s;
+      }
+      workspace.k = -workspace.quu.solve(qu);
+      workspace.s = qx + workspace.qux.transpose() * workspace.k;
+    }
+
+    // forward rollout, projection and multipliers
+    const bool check = iteration % CHECK_ITERATIONS == 0;
+    double     primal_residual = 0.0, dual_residual = 0.0, primal_scale = 1e-10, dual_scale = 1e-10;
+    StateVector x = x0;
+    for (int k = 0; k < N; k++) {
+      Stage     &stage     = stages_[k];
+      Workspace &workspace = workspace_[k];
+      stage.w.head<NX>()   = x;
+      stage.w.tail<NU>()   = workspace.K * x + workspace.k;
+      x                    = A_ * x + B_ * stage.w.tail<NU>();
+
+      const ConstraintVector gw     = G_ * stage.w;
+      const ConstraintVector z_prev = workspace.z;
+      workspace.z                   = (gw + workspace.y / rho_).cwiseMax(stage.lower).cwiseMin(stage.upper);
+      workspace.y += rho_ * (gw - workspace.z);
+
+      // the residuals cost as much as the iteration, so they are not checked in every one
+      if (check) {
+        primal_residual = std::max(primal_residual, (gw - workspace.z).lpNorm<Eigen::Infinity>());
+        dual_residual   = std::max(dual_residual, rho_ * (G_.transpose() * (workspace.z - z_prev)).lpNorm<Eigen::Infinity>());
+        primal_scale    = std::max({primal_scale, gw.lpNorm<Eigen::Infinity>(), workspace.z.lpNorm<Eigen::Infinity>()});
+        dual_scale      = std::max({dual_scale, (stage.P * stage.w).lpNorm<Eigen::Infinity>(), (G_.transpose() * workspace.y).lpNorm<Eigen::Infinity>(),
+                                    stage.q.lpNorm<Eigen::Infinity>()});
+      }
+    }
+
+    if (!check) {
+      continue;
+    }
+    if (primal_residual < tolerance_ && dual_residual < tolerance_) {
+      return iteration;
+    }
+    // balance the residuals changing the penalty, as OSQP does. The recursion is linear in the stages, so computing the gains again is cheap
+    if (iteration % RHO_UPDATE_ITERATIONS == 0) {
+      const double ratio = sqrt((primal_residual / primal_scale) / std::max(dual_residual / dual_scale, 1e-10));
+      if (ratio > 5.0 || ratio < 0.2) {
+        rho_ = std::min(std::max(rho_ * ratio, 1e-6), 1e6);
+        factorize();
+      }
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,163 @@
+#include <riccati_qp_solver.h>
+#include <limits>
+
+NumericalSolver::RiccatiQPSolver::RiccatiQPSolver(const float solving_rate, const int time_horizon, const std::shared_ptr<State[]> &initial_guess) : Solver(solving_rate, time_horizon, initial_guess),
+    trajectory_(time_horizon, 3), target_(time_horizon, 3), hessian_(time_horizon-1), q_(time_horizon-1), grid_solution_(time_horizon){
+    const double h = step_size;
+
+    // p_k+1 = p_k + h*v_k + h^2/2*a_k,  v_k+1 = v_k + h*a_k
+    RiccatiQP::StateMatrix A = RiccatiQP::StateMatrix::Identity();
+    RiccatiQP::InputMatrix B = RiccatiQP::InputMatrix::Zero();
+    RiccatiQP::ConstraintMatrix G = RiccatiQP::ConstraintMatrix::Zero();
+    for(int axis=0; axis<3; axis++){
+        A(PX+axis, VX+axis) = h;
+        B(PX+axis, AX+axis-RiccatiQP::NX) = 0.5*h*h;
+        B(VX+axis, AX+axis-RiccatiQP::NX) = h;
+        G(ACC_X+axis, AX+axis) = 1.0;
+        G(VEL_X+axis, VX+axis) = 1.0;
+    }
+    // height over the target with slack, positive slack
+    G(HEIGHT, PZ) = 1.0;
+    G(HEIGHT, SLACK) = 1.0;
+    G(POSITIVE_SLACK, SLACK) = 1.0;
+
+    hessian_fixed_ = RiccatiQP::StageMatrix::Zero();
+    hessian_fixed_(AX, AX) = 2*W_AX;
+    hessian_fixed_(AY, AY) = 2*W_AY;
+    hessian_fixed_(AZ, AZ) = 2*W_AZ;
+    hessian_fixed_(SLACK, SLACK) = 2*W_SLACK;
+
+    qp_ = std::make_unique<RiccatiQP>(time_horizon-1, A, B, G);
+}
+
+int NumericalSolver::RiccatiQPSolver::solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position, bool first_time_solving, int _drone_id, bool _target /*false*/,bool _multi/*false*/){
+    const int N = solvedHorizon();
+    const double h = step_size;
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    const State start = initialState(_uavs_pose, time_initial_position, first_time_solving, _drone_id);
+    const Eigen::Vector3d p0(start.pose.x, start.pose.y, start.pose.z);
+    const Eigen::Vector3d v0(start.velocity.x, start.velocity.y, start.velocity.z);
+    const Eigen::Vector3d a0 = first_time_solving ? Eigen::Vector3d::Zero() : Eigen::Vector3d(start.acc.x, start.acc.y, start.acc.z);
+    const double max_vel[3] = {MAX_VEL_XY, MAX_VEL_XY, MAX_VEL_Z};
+    const double w_end[2] = {W_PX_N, W_PY_N};
+    const double desired[2] = {_desired_odometry.pose.pose.position.x, _desired_odometry.pose.pose.position.y};
+    const double w_reference[3] = {W_PX, W_PY, W_PZ};
+
+    // the stage k is the step k+1. The state of the first stage is fixed by the initial state
+    RiccatiQP::StateVector x1;
+    x1 << p0+h*v0+0.5*h*h*a0, v0+h*a0;
+
+    // the pitch is measured to the target at every step
+    for(int k=0; k<N && !_target_trajectory.empty(); k++){
+        const geometry_msgs::Point &point = _target_trajectory[std::min<size_t>(k,_target_trajectory.size()-1)].pose.pose.position;
+        target_.row(k) << point.x, point.y, point.z;
+    }
+    // trajectory to linearize the pitch term: the initial guess, and then the last QP solution
+    for(int k=0; k<N; k++){
+        trajectory_.row(k) << initial_guess_[k].pose.x, initial_guess_[k].pose.y, initial_guess_[k].pose.z;
+    }
+
+    // cost and bounds without the pitch term. The stages after the solved horizon are not used
+    qp_->setStages(N-1);
+    std::fill(hessian_.begin(), hessian_.end(), hessian_fixed_);
+    std::fill(q_.begin(), q_.end(), RiccatiQP::StageVector::Zero());
+    for(int stage=0; stage<N-1; stage++){
+        const int k = stage+1;
+        RiccatiQP::Stage &qp_stage = qp_->stage(stage);
+        if(!_reference_trajectory.empty()){
+            // hold the last reference point if the reference is shorter than the horizon
+            const geometry_msgs::Point &point = _reference_trajectory[std::min<size_t>(k,_reference_trajectory.size()-1)].pose.pose.position;
+            const double reference[3] = {point.x, point.y, point.z};
+            for(int axis=0; axis<3; axis++){
+                hessian_[stage](PX+axis, PX+axis) += 2*w_reference[axis];
+                q_[stage](PX+axis) -= 2*w_reference[axis]*reference[axis];
+            }
+        }
+        if(k == N-1){  // the end term of the ACADO problem is only on x and y
+            for(int axis=0; axis<2; axis++){
+                hessian_[stage](PX+axis, PX+axis) += 2*w_end[axis];
+                q_[stage](PX+axis) -= 2*w_end[axis]*desired[axis];
+            }
+        }
+        for(int axis=0; axis<3; axis++){
+            qp_stage.lower(ACC_X+axis) = -MAX_ACC;
+            qp_stage.upper(ACC_X+axis) = MAX_ACC;
+            // the velocity of the first stage is fixed
+            qp_stage.lower(VEL_X+axis) = stage == 0 ? -infinity : -max_vel[axis];
+            qp_stage.upper(VEL_X+axis) = stage == 0 ? infinity : max_vel[axis];
+        }
+        // hold the last target point if the target trajectory is shorter than the horizon, as the pitch term
+        const double target_z = _target_trajectory.empty() ? -infinity : _target_trajectory[std::min<size_t>(k,_target_trajectory.size()-1)].pose.pose.position.z;
+        qp_stage.lower(HEIGHT) = Z_RELATIVE_TARGET_DRONE+target_z;
+        qp_stage.upper(HEIGHT) = infinity;
+        qp_stage.lower(POSITIVE_SLACK) = 0.0;
+        qp_stage.upper(POSITIVE_SLACK) = infinity;
+    }
+
+    // the QP tolerance follows the options. The SQP stops when its time budget is spent, keeping the last QP solution
+    qp_->tolerance_ = QP_TOLERANCE*options_.tolerance_scale;
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    solver_success_ = QP_NOT_CONVERGED;
+    qp_iterations_ = 0;
+    for(int iteration=0; iteration<max_sqp_iterations_; iteration++){
+        for(int stage=0; stage<N-1; stage++){
+            RiccatiQP::Stage &qp_stage = qp_->stage(stage);
+            qp_stage.P = hessian_[stage];
+            qp_stage.q = q_[stage];
+            if(!_target_trajectory.empty()){
+                // Gauss-Newton: r_k(p) ~ r_k(p_bar) + grad_k'(p - p_bar), weighted with the step size as the Lagrange term
+                Eigen::Vector3d gradient;
+                const Eigen::Vector3d p_bar = trajectory_.row(stage+1).transpose();
+                const double residual = pitchResidual(p_bar, target_.row(stage+1).transpose(), gradient)-gradient.dot(p_bar);
+                qp_stage.P.topLeftCorner<3,3>() += 2*h*gradient*gradient.transpose();
+                qp_stage.q.head<3>() += 2*h*residual*gradient;
+            }
+        }
+        qp_->factorize();
+        const int qp_iterations = qp_->solve(x1);
+        if(qp_iterations < 0){
+            solver_success_ = QP_NOT_CONVERGED;
+            break;
+        }
+        qp_iterations_ += qp_iterations;
+        solver_success_ = returnValueType::SUCCESSFUL_RETURN;
+
+        double change = 0.0;
+        trajectory_.row(0) = p0.transpose();
+        for(int stage=0; stage<N-1; stage++){
+            const Eigen::Vector3d position = qp_->stage(stage).w.head<3>();
+            change = std::max(change, (position-trajectory_.row(stage+1).transpose()).lpNorm<Eigen::Infinity>());
+            trajectory_.row(stage+1) = position.transpose();
+        }
+        if(change < sqp_tolerance_*options_.tolerance_scale || std::chrono::duration<double>(std::chrono::steady_clock::now()-start_time).count() > options_.max_time){
+            break;
+        }
+    }
+    if(solver_success_ != returnValueType::SUCCESSFUL_RETURN){
+        return solver_success_;
+    }
+
+    grid_solution_[0] = start;
+    grid_solution_[0].acc.x = a0(0);
+    grid_solution_[0].acc.y = a0(1);
+    grid_solution_[0].acc.z = a0(2);
+    for(int k=1; k<N; k++){
+        const RiccatiQP::StageVector &w = qp_->stage(k-1).w;
+        grid_solution_[k].pose.x = w(PX);
+        grid_solution_[k].pose.y = w(PY);
+        grid_solution_[k].pose.z = w(PZ);
+        grid_solution_[k].velocity.x = w(VX);
+        grid_solution_[k].velocity.y = w(VY);
+        grid_solution_[k].velocity.z = w(VZ);
+        // the QP solution is clipped to the tolerance of the solver
+        grid_solution_[k].acc.x = std::min<double>(std::max<double>(w(AX), -MAX_ACC), MAX_ACC);
+        grid_solution_[k].acc.y = std::min<double>(std::max<double>(w(AY), -MAX_ACC), MAX_ACC);
+        grid_solution_[k].acc.z = std::min<double>(std::max<double>(w(AZ), -MAX_ACC), MAX_ACC);
+    }
+    // the rest of the horizon brakes, as in the ACADO solver
+    brake(grid_solution_.data(), N-1, time_horizon_, step_size, MAX_ACC);
+    setSolution(grid_solution_.data(), time_initial_position, first_time_solving);
+    return solver_success_;
+}
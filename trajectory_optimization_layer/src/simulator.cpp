@@ -0,0 +1,214 @@
+#include <simulator.h>
+
+/** \brief Utility function to fill an odometry msg from position and velocity
+ */
+static nav_msgs::Odometry toOdometry(const Eigen::Vector3d &position, const Eigen::Vector3d &velocity) {
+  nav_msgs::Odometry odometry;
+  odometry.pose.pose.position.x  = position.x();
+  odometry.pose.pose.position.y  = position.y();
+  odometry.pose.pose.position.z  = position.z();
+  odometry.pose.pose.orientation.w = 1.0;
+  odometry.twist.twist.linear.x  = velocity.x();
+  odometry.twist.twist.linear.y  = velocity.y();
+  odometry.twist.twist.linear.z  = velocity.z();
+  return odometry;
+}
+
+Simulation::PointMassUav::PointMassUav(const Eigen::Vector3d &position, const double max_acc, const double time_constant)
+    : position_(position), max_acc_(max_acc), time_constant_(time_constant) {
+}
+
+void Simulation::PointMassUav::step(const Eigen::Vector3d &velocity_command, const double dt) {
+  Eigen::Vector3d acc = (velocity_command - velocity_) / time_constant_;
+  if (acc.norm() > max_acc_) {
+    acc = acc.normalized() * max_acc_;
+  }
+  position_ += velocity_ * dt + 0.5 * acc * dt * dt;
+  velocity_ += acc * dt;
+}
+
+nav_msgs::Odometry Simulation::ConstantVelocityTarget::odometry(const double t) const {
+  return toOdometry(position_ + velocity_ * t, velocity_);
+}
+
+nav_msgs::Odometry Simulation::CircleTarget::odometry(const double t) const {
+  const double angle = speed_ / radius_ * t;
+  const Eigen::Vector3d position = center_ + radius_ * Eigen::Vector3d(cos(angle), sin(angle), 0.0);
+  const Eigen::Vector3d velocity = speed_ * Eigen::Vector3d(-sin(angle), cos(angle), 0.0);
+  return toOdometry(position, velocity);
+}
+
+nav_msgs::Odometry Simulation::StopAndGoTarget::odometry(const double t) const {
+  const double period    = go_time_ + stop_time_;
+  const int    periods   = floor(t / period);
+  const double in_period = t - periods * period;
+  const bool   moving    = in_period < go_time_;
+  const double travelled = periods * go_time_ + std::min(in_period, go_time_);
+  return toOdometry(position_ + velocity_ * travelled, moving ? velocity_ : Eigen::Vector3d::Zero());
+}
+
+Simulation::PlannerHarness::PlannerHarness(const int time_horizon, const float solver_rate, const int drone_id)
+    : backendSolver(time_horizon, solver_rate, drone_id) {
+  first_time_solving_ = true;
+}
+
+void Simulation::PlannerHarness::setBackend(const boost::shared_ptr<NumericalSolver::SolverBackend> &backend) {
+  solver_pt_ = backend;
+  solver_pt_->initialize(solver_rate_, time_horizon_, initial_guess_);
+}
+
+void Simulation::PlannerHarness::setUavState(const Eigen::Vector3d &position, const Eigen::Vector3d &velocity) {
+  uavs_pose_[drone_id_].has_pose         = true;
+  uavs_pose_[drone_id_].state.pose.x     = position.x();
+  uavs_pose_[drone_id_].state.pose.y     = position.y();
+  uavs_pose_[drone_id_].state.pose.z     = position.z();
+  uavs_pose_[drone_id_].state.velocity.x = velocity.x();
+  uavs_pose_[drone_id_].state.velocity.y = velocity.y();
+  uavs_pose_[drone_id_].state.velocity.z = velocity.z();
+}
+
+void Simulation::PlannerHarness::setTarget(const nav_msgs::Odometry &target_odometry) {
+  target_odometry_ = target_odometry;
+  target_has_pose  = true;
+}
+
+void Simulation::PlannerHarness::setDesiredShot(const shot_executer::DesiredShot &desired_shot) {
+  desired_odometry_     = desired_shot.desired_odometry;
+  desired_type_         = desired_shot.type;
+  reference_trajectory_ = desired_shot.reference_trajectory;
+}
+
+void Simulation::PlannerHarness::setNoFlyZone(const std::vector<float> &center) {
+  no_fly_zone_center_ = center;
+  if (no_fly_zone_center_.size() == 2) {
+    calculateNoFlyZonePoints(no_fly_zone_center_[0], no_fly_zone_center_[1], NO_FLY_ZONE_RADIUS);
+  }
+}
+
+bool Simulation::PlannerHarness::solverSucceeded(const int status) {
+  return status == returnValueType::SUCCESSFUL_RETURN || status == returnValueType::RET_MAX_TIME_REACHED;
+}
+
+int Simulation::PlannerHarness::plan(const double time) {
+  const float initial_time = initialTime(time);
+  const int   status       = planningStep(initial_time);
+  if (solverSucceeded(status)) {
+    updatePlanStart(time, initial_time);
+    saveCalculatedTrajectory();
+    first_time_solving_ = false;
+  }
+  return status;
+}
+
+void Simulation::PlannerHarness::getTrajectory(std::vector<geometry_msgs::PoseStamped> &positions, std::vector<geometry_msgs::Twist> &velocities) const {
+  positions.resize(time_horizon_);
+  velocities.resize(time_horizon_);
+  for (int i = 0; i < time_horizon_; i++) {
+    positions[i].pose.position.x = solution_[i].pose.x;
+    positions[i].pose.position.y = solution_[i].pose.y;
+    positions[i].pose.position.z = solution_[i].pose.z;
+    velocities[i].linear.x       = solution_[i].velocity.x;
+    velocities[i].linear.y       = solution_[i].velocity.y;
+    velocities[i].linear.z       = solution_[i].velocity.z;
+  }
+}
+
+std::vector<State> Simulation::PlannerHarness::getSolution() const {
+  return std::vector<State>(solution_.get(), solution_.get() + time_horizon_);
+}
+
+Simulation::ClosedLoopSimulator::ClosedLoopSimulator(const int time_horizon, const float solver_rate) : time_horizon_(time_horizon), solver_rate_(solver_rate) {
+}
+
+Simulation::ScenarioResult Simulation::ClosedLoopSimulator::run(const Scenario &scenario) {
+  ScenarioResult result;
+  result.name = scenario.name;
+
+  SimClock       clock;
+  PointMassUav   uav(scenario.uav_initial_position);
+  PlannerHarness planner(time_horizon_, solver_rate_);
+
+  std::vector<geometry_msgs::PoseStamped> positions;  // trajectory to follow
+  std::vector<geometry_msgs::Twist>       velocities;
+  int                                     pose_on_path = 0;
+
+  shot_executer::DesiredShot      desired_shot;
+  ShotExecuter::target_snapshot   snapshot;
+  const double                    dt         = 1.0 / control_rate_;
+  const int                       steps      = round(scenario.duration * control_rate_);
+  double                          next_shot  = 0.0;
+  double                          next_plan  = 0.0;
+  double                          error_sum  = 0.0;
+  int                             error_cont = 0;
+
+  for (int k = 0; k <= steps; k++) {
+    const double t = clock.now();
+    // target and shot executer
+    snapshot.target_pose = scenario.target->odometry(t);
+    snapshot.drone_pose  = toOdometry(uav.position(), uav.velocity());
+    const double target_vx = snapshot.target_pose.twist.twist.linear.x;
+    const double target_vy = snapshot.target_pose.twist.twist.linear.y;
+    if (sqrt(pow(target_vx, 2) + pow(target_vy, 2)) > MIN_XY_VEL) {
+      snapshot.target_yaw = atan2(target_vy, target_vx);
+    }
+    if (t >= next_shot) {
+      std::vector<nav_msgs::Odometry> target_trajectory = ShotExecuter::velocityConstantPrediction(snapshot.target_pose, time_horizon_, step_size_);
+      desired_shot = ShotExecuter::calculateDesiredPoint(scenario.action, target_trajectory, snapshot);
+      next_shot += 1.0 / shot_rate_;
+    }
+
+    // planner
+    if (t >= next_plan && desired_shot.type != shot_executer::DesiredShot::IDLE) {
+      planner.setUavState(uav.position(), uav.velocity());
+      planner.setTarget(snapshot.target_pose);
+      planner.setDesiredShot(desired_shot);
+      std::chrono::steady_clock::time_point start  = std::chrono::steady_clock::now();
+      const int                             status = planner.plan(t);
+      result.solve_times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+      result.solver_calls++;
+      if (PlannerHarness::solverSucceeded(status)) {
+        planner.getTrajectory(positions, velocities);
+        pose_on_path = 0;
+      } else {
+        result.solver_failures++;
+      }
+      next_plan += 1.0 / solver_rate_;
+    }
+
+    // follower
+    Eigen::Vector3d velocity_command = Eigen::Vector3d::Zero();
+    if (!positions.empty()) {
+      const Eigen::Vector3f current_pose = uav.position().cast<float>();
+      pose_on_path                       = FollowerControl::cal_pose_on_path(positions, current_pose, pose_on_path);
+      const int look_ahead_pose          = FollowerControl::cal_pose_look_ahead(positions, look_ahead_, pose_on_path);
+      if (look_ahead_pose == positions.size()) {  // end of the trajectory
+        positions.clear();
+        velocities.clear();
+        pose_on_path = 0;
+      } else {
+        const Eigen::Vector3f pose_to_go(positions[look_ahead_pose].pose.position.x, positions[look_ahead_pose].pose.position.y,
+                                         positions[look_ahead_pose].pose.position.z);
+        const Eigen::Vector3f vel_to_go(velocities[pose_on_path].linear.x, velocities[pose_on_path].linear.y, velocities[pose_on_path].linear.z);
+        velocity_command = FollowerControl::calculate_vel(pose_to_go, vel_to_go, current_pose).cast<double>();
+      }
+    }
+    uav.step(velocity_command, dt);
+    clock.advance(dt);
+
+    // tracking error with respect to the shot evaluated at the current target pose
+    if (desired_shot.type != shot_executer::DesiredShot::IDLE) {
+      const shot_executer::DesiredShot current_shot =
+          ShotExecuter::calculateDesiredPoint(scenario.action, ShotExecuter::velocityConstantPrediction(scenario.target->odometry(clock.now()), 1, step_size_), snapshot);
+      const Eigen::Vector3d shot_pose(current_shot.desired_odometry.pose.pose.position.x, current_shot.desired_odometry.pose.pose.position.y,
+                                      current_shot.desired_odometry.pose.pose.position.z);
+      result.final_tracking_error = (uav.position() - shot_pose).norm();
+      if (k >= steps / 2) {
+        error_sum += result.final_tracking_error;
+        error_cont++;
+      }
+    }
+  }
+  result.mean_tracking_error = error_cont > 0 ? error_sum / error_cont : 0.0;
+  result.success             = result.solver_failures < result.solver_calls && result.final_tracking_error < success_tolerance_;
+  return result;
+}
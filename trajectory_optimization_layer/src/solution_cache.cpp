@@ -0,0 +1,138 @@
+#include <solution_cache.h>
+#include <cmath>
+#include <cstring>
+
+SolverUtils::SolutionCache::SolutionCache(const int time_horizon, const size_t capacity) : time_horizon_(time_horizon), capacity_(std::max<size_t>(1, capacity)) {
+}
+
+bool SolverUtils::SolutionCache::isPosition(const int feature) const {
+  return feature == X || feature == Y || feature == Z || feature == DESIRED_X || feature == DESIRED_Y || feature == DESIRED_Z || feature == TARGET_X ||
+         feature == TARGET_Y || feature == TARGET_Z || (feature >= NO_FLY_ZONE_X && feature <= UAV_2_Z) ||
+         (feature >= REFERENCE_X && feature <= REFERENCE_Z);
+}
+
+bool SolverUtils::SolutionCache::isVelocity(const int feature) const {
+  return feature == VX || feature == VY || feature == VZ || feature == TARGET_VX || feature == TARGET_VY || feature == TARGET_VZ;
+}
+
+double SolverUtils::SolutionCache::distance(const Features &a, const Features &b) const {
+  double distance = 0.0;
+  for (int i = 0; i < N_FEATURES; i++) {
+    const double difference = fabs(a[i] - b[i]);
+    if (isPosition(i)) {
+      distance = std::max(distance, difference / position_resolution_);
+    } else if (isVelocity(i)) {
+      distance = std::max(distance, difference / velocity_resolution_);
+    } else if (difference > 0.0) {
+      return std::numeric_limits<double>::infinity();
+    }
+  }
+  return distance;
+}
+
+bool SolverUtils::SolutionCache::withinTolerances(const Features &a, const Features &b) const {
+  for (int i = 0; i < N_FEATURES; i++) {
+    const double tolerance = isPosition(i) ? position_tolerance_ : (isVelocity(i) ? velocity_tolerance_ : 0.0);
+    if (fabs(a[i] - b[i]) > tolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::list<SolverUtils::SolutionCache::Entry>::iterator SolverUtils::SolutionCache::nearest(const Features &features) {
+  auto   nearest          = entries_.end();
+  double nearest_distance = 1.0;  // warm start radius
+  for (auto it = entries_.begin(); it != entries_.end(); it++) {
+    const double entry_distance = distance(features, it->features);
+    if (entry_distance <= nearest_distance) {
+      nearest          = it;
+      nearest_distance = entry_distance;
+    }
+  }
+  return nearest;
+}
+
+SolverUtils::SolutionCache::LookupResult SolverUtils::SolutionCache::lookup(const Features &features, State solution[]) {
+  auto it = nearest(features);
+  if (it == entries_.end()) {
+    return MISS;
+  }
+  // most recently used
+  entries_.splice(entries_.begin(), entries_, it);
+  std::copy(it->solution.begin(), it->solution.end(), solution);
+  return withinTolerances(features, it->features) ? HIT : WARM_START;
+}
+
+void SolverUtils::SolutionCache::store(const Features &features, const State solution[]) {
+  auto it = nearest(features);
+  if (it != entries_.end() && withinTolerances(features, it->features)) {
+    entries_.erase(it);
+  } else if (entries_.size() >= capacity_) {
+    entries_.pop_back();
+  }
+  entries_.push_front(Entry{features, std::vector<State>(solution, solution + time_horizon_)});
+}
+
+void SolverUtils::SolutionCache::insert(const Features &features, const State solution[]) {
+  store(features, solution);
+  if (file_.is_open()) {
+    if (file_entries_ >= 2 * capacity_) {  // too many evicted entries in the file
+      rewrite();
+    } else {
+      writeEntry(entries_.front());
+      file_.flush();
+    }
+  }
+}
+
+void SolverUtils::SolutionCache::writeEntry(const Entry &entry) {
+  file_.write(reinterpret_cast<const char *>(entry.features.data()), sizeof(double) * N_FEATURES);
+  file_.write(reinterpret_cast<const char *>(entry.solution.data()), sizeof(State) * time_horizon_);
+  file_entries_++;
+}
+
+bool SolverUtils::SolutionCache::rewrite() {
+  const int header[2] = {FILE_VERSION, time_horizon_};
+  file_.close();
+  file_.open(path_, std::ios::binary | std::ios::trunc);
+  if (!file_.is_open()) {
+    ROS_ERROR("Solution cache: error opening %s", path_.c_str());
+    return false;
+  }
+  file_.write(reinterpret_cast<const char *>(header), sizeof(header));
+  file_entries_ = 0;
+  for (auto it = entries_.rbegin(); it != entries_.rend(); it++) {
+    writeEntry(*it);
+  }
+  file_.flush();
+  return true;
+}
+
+bool SolverUtils::SolutionCache::load(const std::string &path) {
+  // header: version, time horizon. Then features and solution of every entry, oldest first
+  const int header[2] = {FILE_VERSION, time_horizon_};
+  std::ifstream input(path, std::ios::binary);
+  int           file_header[2] = {0, 0};
+  if (input.is_open() && input.read(reinterpret_cast<char *>(file_header), sizeof(file_header))) {
+    if (memcmp(header, file_header, sizeof(header)) == 0) {
+      Features           features;
+      std::vector<State> solution(time_horizon_);
+      while (input.read(reinterpret_cast<char *>(features.data()), sizeof(double) * N_FEATURES) &&
+             input.read(reinterpret_cast<char *>(solution.data()), sizeof(State) * time_horizon_)) {
+        store(features, solution.data());
+      }
+    } else {
+      ROS_WARN("Solution cache: %s was saved with another version or time horizon. Discarding it", path.c_str());
+    }
+  }
+  input.close();
+
+  // rewrite the file without the evicted entries and keep it open to append the new ones
+  path_ = path;
+  if (!rewrite()) {
+    return false;
+  }
+  ROS_INFO("Solution cache: %zu solutions loaded from %s", entries_.size(), path.c_str());
+  return true;
+}
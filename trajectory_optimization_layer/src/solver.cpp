@@ -5,13 +5,193 @@ NumericalSolver::Solver::Solver(const float solving_rate, const int time_horizon
                                                                         solution_(new State[time_horizon]),                                                                
                                                                         initial_guess_(initial_guess)
 {
+    followed_.resize(offset_);
+}
 
+State NumericalSolver::Solver::initialState(std::map<int,UavState> &_uavs_pose, const float time_initial_position, const bool first_time_solving, const int _drone_id) const{
+    if(first_time_solving){
+        return _uavs_pose.at(_drone_id).state;
+    }
+    return interpolate(solution_.get(), time_horizon_, time_initial_position, step_size);
+}
 
+int NumericalSolver::Solver::solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position, bool first_time_solving, int _drone_id, bool _target /*false*/,bool _multi/*false*/){
 
 }
 
-int NumericalSolver::Solver::solverFunction(nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position, bool first_time_solving, int _drone_id, bool _target /*false*/,bool _multi/*false*/){
+void NumericalSolver::Solver::setSolution(const State grid_solution[], const float time_initial_position, const bool first_time_solving){
+    if(first_time_solving){
+        std::copy(grid_solution, grid_solution+time_horizon_, solution_.get());
+        return;
+    }
+    // the first offset_ points are the part of the previous solution that is followed while solving. They are interpolated before
+    // writing them, because the previous solution can be shifted less than offset_ points
+    for(int i=0;i<offset_;i++){
+        followed_[i] = interpolate(solution_.get(), time_horizon_, solutionStart(time_initial_position)+i*step_size, step_size);
+    }
+    std::copy(followed_.begin(), followed_.end(), solution_.get());
+    std::copy(grid_solution, grid_solution+time_horizon_-offset_, solution_.get()+offset_);
+}
 
+State NumericalSolver::Solver::interpolate(const State trajectory[], const int size, const double time, const double step_size){
+    if(time <= 0){
+        return trajectory[0];
+    }
+    const int point = time/step_size+1e-6;  // the times of the points give the point, not the previous one
+    if(point >= size-1){
+        return trajectory[size-1];
+    }
+    const double dt = time-point*step_size;
+    State state = trajectory[point];
+    state.pose.x += dt*state.velocity.x + 0.5*dt*dt*state.acc.x;
+    state.pose.y += dt*state.velocity.y + 0.5*dt*dt*state.acc.y;
+    state.pose.z += dt*state.velocity.z + 0.5*dt*dt*state.acc.z;
+    state.velocity.x += dt*state.acc.x;
+    state.velocity.y += dt*state.acc.y;
+    state.velocity.z += dt*state.acc.z;
+    return state;
 }
 
+void NumericalSolver::Solver::shift(State trajectory[], const int size, const double time, const double step_size){
+    // every point only reads points that have not been written yet: forward in time from the start, backward from the end
+    const State first = trajectory[0];
+    const State last = trajectory[size-1];
+    auto shifted = [&](const int i){
+        const double t = time+i*step_size;
+        return t >= (size-1)*step_size ? last : (t <= 0 ? first : interpolate(trajectory, size, t, step_size));
+    };
+    if(time >= 0){
+        for(int i=0;i<size;i++){
+            trajectory[i] = shifted(i);
+        }
+    }else{
+        for(int i=size-1;i>=0;i--){
+            trajectory[i] = shifted(i);
+        }
+    }
+}
 
+void NumericalSolver::Solver::brake(State trajectory[], const int from, const int size, const double step_size, const double max_acc){
+    auto braking_acc = [&](const double velocity){
+        return -std::copysign(std::min(max_acc, fabs(velocity)/step_size), velocity);
+    };
+    for(int i=from; i<size; i++){
+        trajectory[i].acc.x = braking_acc(trajectory[i].velocity.x);
+        trajectory[i].acc.y = braking_acc(trajectory[i].velocity.y);
+        trajectory[i].acc.z = braking_acc(trajectory[i].velocity.z);
+        if(i+1 < size){
+            trajectory[i+1] = trajectory[i];
+            trajectory[i+1].pose.x += step_size*trajectory[i].velocity.x + 0.5*step_size*step_size*trajectory[i].acc.x;
+            trajectory[i+1].pose.y += step_size*trajectory[i].velocity.y + 0.5*step_size*step_size*trajectory[i].acc.y;
+            trajectory[i+1].pose.z += step_size*trajectory[i].velocity.z + 0.5*step_size*step_size*trajectory[i].acc.z;
+            trajectory[i+1].velocity.x += step_size*trajectory[i].acc.x;
+            trajectory[i+1].velocity.y += step_size*trajectory[i].acc.y;
+            trajectory[i+1].velocity.z += step_size*trajectory[i].acc.z;
+        }
+    }
+}
+
+std::vector<double> NumericalSolver::Solver::solvedGrid() const{
+    const double duration = (solvedHorizon()-1)*step_size;
+    std::vector<double> times;
+    if(options_.time_grid.empty()){
+        for(int i=0;i<solvedHorizon();i++){
+            times.push_back(i*step_size);
+        }
+        return times;
+    }
+    // the time grid covers the whole horizon, the fallback ladder can solve a part of it
+    for(const double time : options_.time_grid){
+        if(time >= duration-1e-6){
+            break;
+        }
+        times.push_back(time);
+    }
+    times.push_back(duration);
+    return times;
+}
+
+std::vector<double> NumericalSolver::Solver::timeGrid(const std::vector<double> &steps, const double duration){
+    std::vector<double> times{0.0};
+    if(steps.size()%2 == 0){
+        return {};
+    }
+    for(size_t part=0; part<steps.size(); part+=2){
+        const double end = part+1 < steps.size() ? std::min(steps[part+1], duration) : duration;
+        if(steps[part] <= 0){
+            return {};
+        }
+        while(times.back() < end-1e-6){
+            // a last step shorter than 10% of the step is joined to the previous one
+            const double next = times.back()+steps[part];
+            times.push_back(next > end-0.1*steps[part] ? end : next);
+        }
+    }
+    return times;
+}
+
+std::vector<double> NumericalSolver::Solver::blockingGrid(const std::vector<int> &blocks, const int time_horizon, const double step_size){
+    std::vector<double> times{0.0};
+    if(blocks.empty() || *std::min_element(blocks.begin(), blocks.end()) <= 0){
+        return {};
+    }
+    int step = 0;
+    for(size_t block=0; step < time_horizon-1; block=std::min(block+1, blocks.size()-1)){
+        step = std::min(step+blocks[block], time_horizon-1);
+        times.push_back(step*step_size);
+    }
+    return times;
+}
+
+geometry_msgs::Point NumericalSolver::Solver::interpolate(const std::vector<nav_msgs::Odometry> &trajectory, const double time, const double step_size){
+    const int size = trajectory.size();
+    const int point = std::min<int>(std::max(time, 0.0)/step_size+1e-6, size-1);
+    geometry_msgs::Point position = trajectory[point].pose.pose.position;
+    if(point+1 < size){
+        const double weight = std::max(time, 0.0)/step_size-point;
+        const geometry_msgs::Point &next = trajectory[point+1].pose.pose.position;
+        position.x += weight*(next.x-position.x);
+        position.y += weight*(next.y-position.y);
+        position.z += weight*(next.z-position.z);
+    }
+    return position;
+}
+
+void NumericalSolver::Solver::toUniform(const State nodes[], const std::vector<double> &times, State trajectory[], const int size, const double step_size){
+    int node = 0;
+    auto at = [&](const double time){
+        while(node+1 < (int)times.size() && times[node+1] <= time+1e-9){
+            node++;
+        }
+        // constant acceleration from the node
+        const double dt = time-times[node];
+        State state = nodes[node];
+        state.pose.x += dt*state.velocity.x + 0.5*dt*dt*state.acc.x;
+        state.pose.y += dt*state.velocity.y + 0.5*dt*dt*state.acc.y;
+        state.pose.z += dt*state.velocity.z + 0.5*dt*dt*state.acc.z;
+        state.velocity.x += dt*state.acc.x;
+        state.velocity.y += dt*state.acc.y;
+        state.velocity.z += dt*state.acc.z;
+        return state;
+    };
+    State next = at(0.0);
+    for(int k=0;k<size;k++){
+        trajectory[k] = next;
+        if(k+1 < size){
+            next = at((k+1)*step_size);
+            trajectory[k].acc.x = (next.velocity.x-trajectory[k].velocity.x)/step_size;
+            trajectory[k].acc.y = (next.velocity.y-trajectory[k].velocity.y)/step_size;
+            trajectory[k].acc.z = (next.velocity.z-trajectory[k].velocity.z)/step_size;
+        }
+    }
+}
+
+double NumericalSolver::Solver::pitchResidual(const Eigen::Vector3d &position, const Eigen::Vector3d &target, Eigen::Vector3d &gradient) const{
+    const float eps = 0.00001;  // as in ACADO
+    const Eigen::Vector3d d = position-target;
+    const double horizontal = sqrt(d(0)*d(0)+d(1)*d(1)+eps);
+    gradient(0) = -d(2)*d(0)/pow(horizontal,3);
+    gradient(1) = -d(2)*d(1)/pow(horizontal,3);
+    gradient(2) = 1.0/horizontal;
+    return d(2)/horizontal-CAMERA_PITCH;
+}
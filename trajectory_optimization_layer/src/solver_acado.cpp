@@ -7,7 +7,7 @@ NumericalSolver::ACADOSolver::ACADOSolver(const float solving_rate, const int ti
 
 
 
-int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position, bool first_time_solving, int _drone_id, bool _target /*false*/,bool _multi/*false*/){
+int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_odometry, const std::vector<float> &_obst, const std::vector<nav_msgs::Odometry> &_target_trajectory, const std::vector<nav_msgs::Odometry> &_reference_trajectory, std::map<int,UavState> &_uavs_pose, float time_initial_position, bool first_time_solving, int _drone_id, bool _target /*false*/,bool _multi/*false*/){
     DifferentialState px_,py_,pz_,vx_,vy_,vz_;
     //DifferentialState   dummy;  // dummy state
     Control ax_,ay_,az_;
@@ -15,18 +15,39 @@ int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_o
     Control s  ;  // slack variable
     // Parameter tx,ty,tz;
 
-    DifferentialEquation model;
-    Grid my_grid_( t_start,t_end,time_horizon_ );
+    // the fallback ladder can optimize a shorter horizon, and the nodes can be non equidistant (time_grid option)
+    const std::vector<double> times = solvedGrid();
+    const int nodes = times.size();
+    DVector grid_times(nodes);
+    for(int i=0; i<nodes; i++){
+        grid_times(i) = t_start+times[i];
+    }
+    Grid my_grid_( grid_times );
 
     float eps = 0.00001;
-    // define the model
-    model << dot(px_) == vx_;
-    model << dot(py_) == vy_;
-    model << dot(pz_) == vz_;
-    model << dot(vx_) == ax_;
-    model << dot(vy_) == ay_;
-    model << dot(vz_) == az_;
-    
+    // define the model. The double integrator with constant acceleration along the step has an exact discretization, so there is
+    // nothing to integrate: the states and their sensitivities are linear maps. It needs one step length
+    const bool discrete = options_.discrete_dynamics && options_.time_grid.empty();
+    DifferentialEquation continuous_model;
+    DiscretizedDifferentialEquation discrete_model(step_size);
+    DifferentialEquation &model = discrete ? discrete_model : continuous_model;
+    if(discrete){
+        const double h = step_size;
+        model << next(px_) == px_ + h*vx_ + 0.5*h*h*ax_;
+        model << next(py_) == py_ + h*vy_ + 0.5*h*h*ay_;
+        model << next(pz_) == pz_ + h*vz_ + 0.5*h*h*az_;
+        model << next(vx_) == vx_ + h*ax_;
+        model << next(vy_) == vy_ + h*ay_;
+        model << next(vz_) == vz_ + h*az_;
+    }else{
+        model << dot(px_) == vx_;
+        model << dot(py_) == vy_;
+        model << dot(pz_) == vz_;
+        model << dot(vx_) == ax_;
+        model << dot(vy_) == ay_;
+        model << dot(vz_) == az_;
+    }
+
 
     OCP ocp(my_grid_);// = new OCP( my_grid_); // possibility to set non equidistant time-horizon of the problem
     ocp.subjectTo(model);
@@ -34,11 +55,12 @@ int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_o
     DVector target_x(my_grid_.getNumPoints());
     DVector target_y(my_grid_.getNumPoints());
     DVector target_z(my_grid_.getNumPoints());
-    // // //set target trajectory
-    for(uint i=0; i<time_horizon_; i++){
-        target_x(i)=_target_trajectory[i].pose.pose.position.x;
-        target_y(i)=_target_trajectory[i].pose.pose.position.y;
-        target_z(i)=_target_trajectory[i].pose.pose.position.z;
+    // target trajectory at the nodes
+    for(int i=0; i<nodes; i++){
+        const geometry_msgs::Point target = interpolate(_target_trajectory, times[i], step_size);
+        target_x(i)=target.x;
+        target_y(i)=target.y;
+        target_z(i)=target.z;
     }
 
     ocp.subjectTo(  -MAX_ACC <= ax_ <=  MAX_ACC   );  
@@ -52,23 +74,24 @@ int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_o
 
 
 
+    const State start = initialState(_uavs_pose, time_initial_position, first_time_solving, _drone_id);
     if(first_time_solving){
-        ocp.subjectTo( AT_START, px_ == _uavs_pose.at(_drone_id).state.pose.x);
-        ocp.subjectTo( AT_START, py_ == _uavs_pose.at(_drone_id).state.pose.y);
-        ocp.subjectTo( AT_START, pz_ == _uavs_pose.at(_drone_id).state.pose.z);
+        ocp.subjectTo( AT_START, px_ == start.pose.x);
+        ocp.subjectTo( AT_START, py_ == start.pose.y);
+        ocp.subjectTo( AT_START, pz_ == start.pose.z);
         ocp.subjectTo( AT_START, ax_ == 0.0);
         ocp.subjectTo( AT_START, ay_ == 0.0);
         ocp.subjectTo( AT_START, az_ == 0.0);
     }else{     
-        ocp.subjectTo( AT_START, px_ == solution_[(time_initial_position/step_size)+offset_].pose.x);
-        ocp.subjectTo( AT_START, py_ == solution_[(time_initial_position/step_size)+offset_].pose.y);
-        ocp.subjectTo( AT_START, pz_ == solution_[(time_initial_position/step_size)+offset_].pose.z);
-        ocp.subjectTo( AT_START, vx_ == solution_[(time_initial_position/step_size)+offset_].velocity.x);
-        ocp.subjectTo( AT_START, vy_ == solution_[(time_initial_position/step_size)+offset_].velocity.y);
-        ocp.subjectTo( AT_START, vz_ == solution_[(time_initial_position/step_size)+offset_].velocity.z);
-        ocp.subjectTo( AT_START, ax_ == solution_[(time_initial_position/step_size)+offset_].acc.x);
-        ocp.subjectTo( AT_START, ay_ == solution_[(time_initial_position/step_size)+offset_].acc.y);
-        ocp.subjectTo( AT_START, az_ == solution_[(time_initial_position/step_size)+offset_].acc.z);
+        ocp.subjectTo( AT_START, px_ == start.pose.x);
+        ocp.subjectTo( AT_START, py_ == start.pose.y);
+        ocp.subjectTo( AT_START, pz_ == start.pose.z);
+        ocp.subjectTo( AT_START, vx_ == start.velocity.x);
+        ocp.subjectTo( AT_START, vy_ == start.velocity.y);
+        ocp.subjectTo( AT_START, vz_ == start.velocity.z);
+        ocp.subjectTo( AT_START, ax_ == start.acc.x);
+        ocp.subjectTo( AT_START, ay_ == start.acc.y);
+        ocp.subjectTo( AT_START, az_ == start.acc.z);
     }
 
     //ocp.subjectTo( s >= 0 ); slack variable
@@ -94,14 +117,52 @@ int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_o
     // r_1(3) = _desired_odometry.twist.twist.linear.y;
     // r_1(4) = _desired_odometry.twist.twist.linear.y;
     // r_1(5) = _desired_odometry.twist.twist.linear.z;
-    //use target_x and targety_ptr
-    ocp.minimizeLagrangeTerm(pow((pz_-_target_trajectory[0].pose.pose.position.z)/sqrt(
-                                                                        pow(px_-_target_trajectory[0].pose.pose.position.x,2)+
-                                                                        pow(py_-_target_trajectory[0].pose.pose.position.y,2)
-                                                                        +eps)-CAMERA_PITCH
-                                ,2));
+    // camera pitch as a least squares residual, so the whole objective is LSQ and Gauss-Newton is used. The target is taken where it
+    // is at every node: its prediction has constant velocity, so it is its first point plus the velocity times the time of the node
+    TIME t;
+    const geometry_msgs::Point target_start = _target_trajectory[0].pose.pose.position;
+    const geometry_msgs::Point target_next = interpolate(_target_trajectory, step_size, step_size);
+    const Expression tx = target_start.x + (target_next.x-target_start.x)/step_size*t;
+    const Expression ty = target_start.y + (target_next.y-target_start.y)/step_size*t;
+    const Expression tz = target_start.z + (target_next.z-target_start.z)/step_size*t;
+    Function h_pitch;
+
+    h_pitch << (pz_-tz)/sqrt(pow(px_-tx,2)+pow(py_-ty,2)+eps)-CAMERA_PITCH;
+
+    DMatrix S_pitch(1,1);
+    DVector r_pitch(1);
+
+    S_pitch(0,0) = step_size;  // weight of the sum at the nodes, as the integral of the Lagrange term it replaces
+    r_pitch(0) = 0.0;
+    ocp.minimizeLSQ( S_pitch, h_pitch, r_pitch );
     ocp.minimizeLSQEndTerm( S_1, h_1, r_1 );
 
+    // tracking cost: follow the shot reference over the whole horizon, not only at the end
+    if(!_reference_trajectory.empty()){
+        Function h_ref;
+
+        h_ref << px_;
+        h_ref << py_;
+        h_ref << pz_;
+
+        DMatrix S_ref(3,3);
+        VariablesGrid r_ref(3,my_grid_);
+
+        S_ref.setIdentity();
+        S_ref(0,0) = W_PX;
+        S_ref(1,1) = W_PY;
+        S_ref(2,2) = W_PZ;
+
+        for(int i=0; i<nodes; i++){
+            // hold the last reference point if the reference is shorter than the horizon
+            const geometry_msgs::Point reference = interpolate(_reference_trajectory, times[i], step_size);
+            r_ref(i,0) = reference.x;
+            r_ref(i,1) = reference.y;
+            r_ref(i,2) = reference.z;
+        }
+        ocp.minimizeLSQ( S_ref, h_ref, r_ref );
+    }
+
     Function h;
 
     h << ax_;
@@ -131,17 +192,18 @@ int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_o
     ////////////////// INITIALIZATION //////////////////////////////////
     VariablesGrid state_init(6,my_grid_), control_init(4,my_grid_);
    
-    for(uint i=0; i<time_horizon_; i++){
-        control_init(i,0)= initial_guess_[i].acc.x;
-        control_init(i,1)= initial_guess_[i].acc.y;
-        control_init(i,2)= initial_guess_[i].acc.z;
+    for(int i=0; i<nodes; i++){
+        const State guess = interpolate(initial_guess_.get(), time_horizon_, times[i], step_size);
+        control_init(i,0)= guess.acc.x;
+        control_init(i,1)= guess.acc.y;
+        control_init(i,2)= guess.acc.z;
         control_init(i,3)=0.0; //slack
-        state_init(i,0)= initial_guess_[i].pose.x;
-        state_init(i,1)= initial_guess_[i].pose.y;
-        state_init(i,2)= initial_guess_[i].pose.z;
-        state_init(i,3)= initial_guess_[i].velocity.x;
-        state_init(i,4)= initial_guess_[i].velocity.y;
-        state_init(i,5)= initial_guess_[i].velocity.z;
+        state_init(i,0)= guess.pose.x;
+        state_init(i,1)= guess.pose.y;
+        state_init(i,2)= guess.pose.z;
+        state_init(i,3)= guess.velocity.x;
+        state_init(i,4)= guess.velocity.y;
+        state_init(i,5)= guess.velocity.z;
        // control(i,3) = _initial_guess["pitch"][i];
     //    inter_state_init(i,0) = 0.2;
     }
@@ -151,11 +213,14 @@ int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_o
     // solver.initializeAlgebraicStates(inter_state_init);
 
     //solver.set( INTEGRATOR_TYPE      , INT_RK78        );
-    solver.set( INTEGRATOR_TOLERANCE , 1e-8            );
+    if(!discrete){
+        solver.set( INTEGRATOR_TOLERANCE , 1e-8            );
+    }
+    solver.set( HESSIAN_APPROXIMATION, GAUSS_NEWTON    );
     //solver.set( DISCRETIZATION_TYPE  , SINGLE_SHOOTING );
-    solver.set( KKT_TOLERANCE        , 1e-3            );
+    solver.set( KKT_TOLERANCE        , 1e-3*options_.tolerance_scale );
     // solver.set( MAX_NUM_ITERATIONS        , 5  );
-    solver.set( MAX_TIME        , 1.0  );
+    solver.set( MAX_TIME        , options_.max_time  );
 
     // call the solver
     solver_success_ = solver.solve();
@@ -202,31 +267,26 @@ int NumericalSolver::ACADOSolver::solverFunction( nav_msgs::Odometry &_desired_o
     solver.getControls          (output_control);
 
     if(solver_success_ == returnValueType::SUCCESSFUL_RETURN || solver_success_ == returnValueType::RET_MAX_TIME_REACHED){ 
-        for(int i=0;i<time_horizon_;i++){
-
-            if(i<offset_  && !first_time_solving){ 
-                solution_[i].pose.x=       solution_  [(time_initial_position/step_size)+i].pose.x;
-                solution_[i].pose.y=       solution_  [(time_initial_position/step_size)+i].pose.y;
-                solution_[i].pose.z=       solution_  [(time_initial_position/step_size)+i].pose.z;
-                solution_[i].velocity.x=   solution_[(time_initial_position/step_size)+i].velocity.x;
-                solution_[i].velocity.y=   solution_[(time_initial_position/step_size)+i].velocity.y;
-                solution_[i].velocity.z=   solution_[(time_initial_position/step_size)+i].velocity.z;
-                solution_[i].acc.x=      solution_[(time_initial_position/step_size)+i].acc.x;
-                solution_[i].acc.y=      solution_[(time_initial_position/step_size)+i].acc.y;
-                solution_[i].acc.z=      solution_[(time_initial_position/step_size)+i].acc.z;
-            }else{
-                solution_[i].pose.x=output_states(i-offset_*(int)!first_time_solving,0);
-                solution_[i].pose.y=output_states(i-offset_*(int)!first_time_solving,1);
-                solution_[i].pose.z=output_states(i-offset_*(int)!first_time_solving,2);
-                solution_[i].velocity.x=output_states(i-offset_*(int)!first_time_solving,3);
-                solution_[i].velocity.y=output_states(i-offset_*(int)!first_time_solving,4);
-                solution_[i].velocity.z=output_states(i-offset_*(int)!first_time_solving,5);
-                solution_[i].acc.x=output_control(i-offset_*(int)!first_time_solving,0);
-                solution_[i].acc.y=output_control(i-offset_*(int)!first_time_solving,1);
-                solution_[i].acc.z=output_control(i-offset_*(int)!first_time_solving,2);
-                // csv<<output_control(i,3)<<std::endl;
-            }
+        const int horizon = solvedHorizon();
+        const std::vector<double> times = solvedGrid();
+        std::vector<State> node_solution(times.size());
+        for(size_t i=0;i<times.size();i++){
+            node_solution[i].pose.x=output_states(i,0);
+            node_solution[i].pose.y=output_states(i,1);
+            node_solution[i].pose.z=output_states(i,2);
+            node_solution[i].velocity.x=output_states(i,3);
+            node_solution[i].velocity.y=output_states(i,4);
+            node_solution[i].velocity.z=output_states(i,5);
+            node_solution[i].acc.x=output_control(i,0);
+            node_solution[i].acc.y=output_control(i,1);
+            node_solution[i].acc.z=output_control(i,2);
+            // csv<<output_control(i,3)<<std::endl;
         }
+        // the solution is given every step
+        std::vector<State> grid_solution(time_horizon_);
+        toUniform(node_solution.data(), times, grid_solution.data(), horizon, step_size);
+        brake(grid_solution.data(), horizon-1, time_horizon_, step_size, MAX_ACC);
+        setSolution(grid_solution.data(), time_initial_position, first_time_solving);
     }
     return true;
  }
\ No newline at end of file
@@ -9,6 +9,9 @@ int main(int _argc, char **_argv)
 {
     // ros node initialization
     ros::init(_argc, _argv,"solver");
+    // kill -USR1 <pid> dumps the trace of the planning loop
+    const std::string trace_file = Trace::install(ros::this_node::getName());
+    ROS_INFO("Trace of %s in %s", ros::this_node::getName().c_str(), trace_file.c_str());
     ros::NodeHandle pnh = ros::NodeHandle("~");
     ros::NodeHandle nh;
     const int time_horizon = 40;
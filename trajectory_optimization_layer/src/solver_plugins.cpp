@@ -0,0 +1,8 @@
+#include <pluginlib/class_list_macros.h>
+#include <solver_acado.h>
+#include <condensed_qp_solver.h>
+#include <riccati_qp_solver.h>
+
+PLUGINLIB_EXPORT_CLASS(NumericalSolver::ACADOBackend, NumericalSolver::SolverBackend)
+PLUGINLIB_EXPORT_CLASS(NumericalSolver::CondensedQPBackend, NumericalSolver::SolverBackend)
+PLUGINLIB_EXPORT_CLASS(NumericalSolver::RiccatiQPBackend, NumericalSolver::SolverBackend)
@@ -0,0 +1,54 @@
+#include <trajectory_resampler.h>
+#include <cmath>
+
+SolverUtils::TrajectoryResampler::TrajectoryResampler(const int time_horizon, const double step_size, const double output_step)
+    : step_size_(step_size), output_step_(output_step > 0.0 ? output_step : step_size), coefficients_(time_horizon, N_COLUMNS) {
+  // samples from the first to the last point of the horizon, both included
+  const int samples = std::floor((time_horizon - 1) * step_size_ / output_step_ + 1e-6) + 1;
+  segment_.resize(samples);
+  tau_.resize(samples);
+  for (int j = 0; j < samples; j++) {
+    const double time = j * output_step_;
+    segment_[j]       = std::min<int>(std::floor(time / step_size_ + 1e-6), time_horizon - 1);
+    tau_(j)           = std::max(time - segment_[j] * step_size_, 0.0);
+  }
+  samples_.resize(samples, N_COLUMNS);
+}
+
+int SolverUtils::TrajectoryResampler::resample(const State trajectory[], const int size, const double yaw[], const double pitch[]) {
+  const int n = std::min<int>(size, coefficients_.rows());
+  if (n <= 0) {
+    return 0;
+  }
+  // coefficients of every segment, the last point is a segment of zero length
+  double unwrapped_yaw = yaw[0];
+  for (int k = 0; k < n; k++) {
+    const State &state = trajectory[k];
+    coefficients_.row(k).head<AZ + 1>() << state.pose.x, state.pose.y, state.pose.z, state.velocity.x, state.velocity.y, state.velocity.z, state.acc.x,
+        state.acc.y, state.acc.z;
+    coefficients_(k, YAW)   = unwrapped_yaw;
+    coefficients_(k, PITCH) = pitch[k];
+    if (k + 1 < n) {
+      unwrapped_yaw += std::remainder(yaw[k + 1] - yaw[k], 2 * M_PI);
+      coefficients_(k, YAW_RATE)   = (unwrapped_yaw - coefficients_(k, YAW)) / step_size_;
+      coefficients_(k, PITCH_RATE) = (pitch[k + 1] - pitch[k]) / step_size_;
+    } else {
+      coefficients_(k, YAW_RATE)   = 0.0;
+      coefficients_(k, PITCH_RATE) = 0.0;
+    }
+  }
+  // the last sample is the last point
+  const int samples = std::floor((n - 1) * step_size_ / output_step_ + 1e-6) + 1;
+  for (int j = 0; j < samples; j++) {
+    samples_.row(j) = coefficients_.row(segment_[j]);
+  }
+
+  // p + v*tau + a*tau^2/2, v + a*tau, a
+  const auto           tau = tau_.head(samples);
+  auto                 out = samples_.topRows(samples).array();
+  out.middleCols<3>(PX) += out.middleCols<3>(VX).colwise() * tau + out.middleCols<3>(AX).colwise() * (0.5 * tau * tau);
+  out.middleCols<3>(VX) += out.middleCols<3>(AX).colwise() * tau;
+  out.col(YAW) += out.col(YAW_RATE) * tau;
+  out.col(PITCH) += out.col(PITCH_RATE) * tau;
+  return samples;
+}
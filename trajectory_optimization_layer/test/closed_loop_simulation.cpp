@@ -0,0 +1,123 @@
+#include <simulator.h>
+#include <riccati_qp_solver.h>
+#include <random>
+#include <algorithm>
+
+/** Closed-loop test of the planner: random shot scenarios (FOLLOW, FLYOVER, ELEVATOR, GOTO, ESTABLISH) with scripted targets
+ *  are simulated faster than real time. It reports tracking error, solve-time distribution and success rate.
+ *  Usage: closed_loop_simulation [number_of_scenarios] [min_success_rate]
+ *  Returns 1 if the success rate is lower than min_success_rate, or if a warmed up solve of the Riccati backend allocates (it is
+ *  linked with the allocation interposer)
+ */
+
+/** \brief Utility function to get a percentile of a sorted vector
+ */
+double percentile(const std::vector<double> &sorted, const double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  return sorted[std::min<size_t>(sorted.size() - 1, p * sorted.size())];
+}
+
+/** \brief Random scenario. The same seed gives the same scenarios
+ */
+Simulation::Scenario randomScenario(std::mt19937 &generator, const int id) {
+  std::uniform_real_distribution<double> position(-10.0, 10.0);
+  std::uniform_real_distribution<double> speed(0.0, 0.8);
+  std::uniform_real_distribution<double> heading(-M_PI, M_PI);
+  std::uniform_int_distribution<int>     shot_type(shot_executer::ShootingAction::Request::GOTO, shot_executer::ShootingAction::Request::ELEVATOR);
+  std::uniform_int_distribution<int>     target_type(0, 2);
+
+  Simulation::Scenario scenario;
+  scenario.uav_initial_position = Eigen::Vector3d(position(generator), position(generator), 3.0);
+
+  const Eigen::Vector3d target_position(position(generator), position(generator), 0.0);
+  const double          target_heading = heading(generator);
+  const Eigen::Vector3d target_velocity = speed(generator) * Eigen::Vector3d(cos(target_heading), sin(target_heading), 0.0);
+  std::string           target_name;
+  switch (target_type(generator)) {
+    case 0:
+      scenario.target = std::make_shared<Simulation::ConstantVelocityTarget>(target_position, target_velocity);
+      target_name     = "constant_velocity";
+      break;
+    case 1:
+      scenario.target = std::make_shared<Simulation::CircleTarget>(target_position, 10.0, target_velocity.norm());
+      target_name     = "circle";
+      break;
+    default:
+      scenario.target = std::make_shared<Simulation::StopAndGoTarget>(target_position, target_velocity, 5.0, 3.0);
+      target_name     = "stop_and_go";
+      break;
+  }
+
+  scenario.action.shooting_action_type = shot_type(generator);
+  scenario.action.target_type          = 1;
+  switch (scenario.action.shooting_action_type) {
+    case shot_executer::ShootingAction::Request::GOTO:
+    case shot_executer::ShootingAction::Request::ESTABLISH:
+      scenario.action.rt_parameters.x = position(generator);
+      scenario.action.rt_parameters.y = position(generator);
+      scenario.action.rt_parameters.z = 3.0;
+      break;
+    default:  // relative to the target
+      scenario.action.rt_parameters.x = -5.0;
+      scenario.action.rt_parameters.y = 0.0;
+      scenario.action.rt_parameters.z = 3.0;
+      break;
+  }
+  scenario.name = "scenario " + std::to_string(id) + " shot " + std::to_string(scenario.action.shooting_action_type) + " target " + target_name;
+  return scenario;
+}
+
+int main(int _argc, char **_argv) {
+  const int    number_of_scenarios = _argc > 1 ? std::stoi(_argv[1]) : 10;
+  const double min_success_rate    = _argc > 2 ? std::stod(_argv[2]) : 0.8;
+
+  // once warmed up, the solves of the Riccati backend are allocation free. ACADO and the condensed QP still allocate in every solve
+  if (!SolverUtils::AllocationCounter::enabled()) {
+    std::cout << "FAIL: the allocations are not counted, the allocation interposer is not linked" << std::endl;
+    return 1;
+  }
+  Simulation::PlannerHarness riccati_planner(40, 1.0);
+  riccati_planner.setBackend(boost::make_shared<NumericalSolver::RiccatiQPBackend>());
+  const uint64_t warm_up_allocations = riccati_planner.warmUp();
+  std::cout << "allocations of a warmed up solve of the Riccati backend: " << warm_up_allocations << std::endl;
+  if (warm_up_allocations > 0) {
+    std::cout << "FAIL: a warmed up solve of the Riccati backend allocates" << std::endl;
+    return 1;
+  }
+
+  std::mt19937                    generator(1);
+  Simulation::ClosedLoopSimulator simulator;
+  std::vector<double>             solve_times;
+  std::vector<double>             tracking_errors;
+  int                             successes       = 0;
+  int                             solver_calls    = 0;
+  int                             solver_failures = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < number_of_scenarios; i++) {
+    const Simulation::ScenarioResult result = simulator.run(randomScenario(generator, i));
+    successes += result.success;
+    solver_calls += result.solver_calls;
+    solver_failures += result.solver_failures;
+    solve_times.insert(solve_times.end(), result.solve_times.begin(), result.solve_times.end());
+    tracking_errors.push_back(result.mean_tracking_error);
+    std::cout << result.name << ": " << (result.success ? "success" : "FAIL") << ", mean error " << result.mean_tracking_error << " m, final error "
+              << result.final_tracking_error << " m, solver failures " << result.solver_failures << "/" << result.solver_calls << std::endl;
+  }
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::sort(solve_times.begin(), solve_times.end());
+  std::sort(tracking_errors.begin(), tracking_errors.end());
+  const double success_rate = number_of_scenarios > 0 ? (double)successes / number_of_scenarios : 1.0;
+
+  std::cout << "scenarios: " << number_of_scenarios << " in " << elapsed << " s (" << number_of_scenarios / elapsed * 60.0 << " per minute)" << std::endl;
+  std::cout << "success rate: " << success_rate << std::endl;
+  std::cout << "solver failures: " << solver_failures << "/" << solver_calls << std::endl;
+  std::cout << "solve time (s): p50 " << percentile(solve_times, 0.5) << ", p95 " << percentile(solve_times, 0.95) << ", max "
+            << percentile(solve_times, 1.0) << std::endl;
+  std::cout << "mean tracking error (m): p50 " << percentile(tracking_errors, 0.5) << ", p95 " << percentile(tracking_errors, 0.95) << std::endl;
+
+  return success_rate >= min_success_rate ? 0 : 1;
+}